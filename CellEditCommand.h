@@ -2,8 +2,12 @@
 #define CELLEDITCOMMAND_H
 #include <QUndoCommand>
 #include <QStandardItemModel>
+#include <QVector>
 
-class CellEditCommand : public QUndoCommand {
+#include "catalogmodel.h"
+#include "historycommand.h"
+
+class CellEditCommand : public HistoryCommand {
 public:
   CellEditCommand(QStandardItemModel* model,
                   int row, int col,
@@ -14,9 +18,34 @@ public:
   void undo() override;
   void redo() override;
 
+  Type type() const override { return CellEdit; }
+  void write(QDataStream& out) const override;
+  static CellEditCommand* read(QDataStream& in, CatalogModel* model);
+
 private:
   QStandardItemModel*  m;
   int                  r, c;
   QString              oldValue, newValue;
 };
+
+class BatchEditCommand : public HistoryCommand {
+public:
+  BatchEditCommand(CatalogModel* model,
+                   const QVector<CatalogModel::CellChange>& changes,
+                   const QString& text,
+                   QUndoCommand* parent = nullptr);
+
+  void undo() override;
+  void redo() override;
+
+  Type type() const override { return BatchEdit; }
+  void write(QDataStream& out) const override;
+  static BatchEditCommand* read(QDataStream& in, CatalogModel* model);
+
+  const QVector<CatalogModel::CellChange>& changes() const { return cells; }
+
+private:
+  CatalogModel*                       m;
+  QVector<CatalogModel::CellChange>   cells;
+};
 #endif // CELLEDITCOMMAND_H
\ No newline at end of file
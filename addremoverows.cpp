@@ -1,20 +1,47 @@
 #include "addremoverows.h"
 
-AddRowCommand::AddRowCommand(QStandardItemModel* m)  : model(m), row(m->rowCount()) 
+#include <algorithm>
+
+namespace {
+
+// Consecutive rows as (first, count) runs, lowest first.
+QVector<QPair<int, int>> rowRanges(QVector<int> rows)
+{
+    std::sort(rows.begin(), rows.end());
+    QVector<QPair<int, int>> ranges;
+    for (int r : rows)
+    {
+        if (!ranges.isEmpty() && r < ranges.last().first + ranges.last().second)
+            continue;
+        if (!ranges.isEmpty() && r == ranges.last().first + ranges.last().second)
+            ++ranges.last().second;
+        else
+            ranges.append(qMakePair(r, 1));
+    }
+    return ranges;
+}
+
+} // namespace
+
+AddRowCommand::AddRowCommand(CatalogModel* m)  : model(m), row(m->rowCount()) 
+{
+    setText("Add Row");
+}
+AddRowCommand::AddRowCommand(CatalogModel* m, int r) : model(m), row(r)
 {
     setText("Add Row");
 }
 void AddRowCommand::undo() 
 {
+    if (muted()) return;
     model->removeRow(row);
 }
 void AddRowCommand::redo() 
 {
-    QList<QStandardItem*> items;
-    items << new QStandardItem(QObject::tr("New book"))
-          << new QStandardItem(QObject::tr("Author"))
-          << new QStandardItem(QString::number(1));
-    model->insertRow(row, items);
+    if (muted()) return;
+    model->insertRow(row, model->makeRow(QObject::tr("New book"),
+                                         QObject::tr("Author"),
+                                         QString::number(1)));
 }
 
 RemoveRowsCommand::RemoveRowsCommand(QStandardItemModel* m, const QVector<int>& rows) : model(m), rowsToRemove(rows) 
@@ -32,25 +59,81 @@ RemoveRowsCommand::RemoveRowsCommand(QStandardItemModel* m, const QVector<int>&
     }
 }
 
-void RemoveRowsCommand::undo() 
+RemoveRowsCommand::RemoveRowsCommand(QStandardItemModel* m, const QVector<int>& rows, const QVector<QVector<QVariant>>& removed)
+    : model(m), rowsToRemove(rows), backup(removed)
 {
-    for (int i = 0; i < rowsToRemove.size(); i++) 
+    setText("Remove Rows");
+}
+
+// Rows go back a run at a time, lowest first, so each lands at its old
+// position; their cells are filled once all runs are in place.
+void RemoveRowsCommand::undo()
+{
+    if (muted()) return;
+    for (const QPair<int, int>& range : rowRanges(rowsToRemove))
+        model->insertRows(range.first, range.second);
+    for (int i = 0; i < rowsToRemove.size(); i++)
     {
-        int r = rowsToRemove[i];
-        model->insertRow(r);
-        for (int c = 0; c < backup[i].size(); c++) 
-        {
+        const int r = rowsToRemove[i];
+        for (int c = 0; c < backup[i].size(); c++)
             model->setData(model->index(r, c), backup[i][c], Qt::EditRole);
-        }
     }
 }
-    
+
+// Removed a run at a time from the bottom up, so the rows above never move
+// and observers see one removal per run instead of one per row.
 void RemoveRowsCommand::redo()
 {
-    auto rows = rowsToRemove;
-    std::sort(rows.begin(), rows.end(), std::greater<>());
-    for (int r : rows) 
+    if (muted()) return;
+    const QVector<QPair<int, int>> ranges = rowRanges(rowsToRemove);
+    for (int i = ranges.size() - 1; i >= 0; --i)
+        model->removeRows(ranges[i].first, ranges[i].second);
+}
+
+void AddRowCommand::write(QDataStream& out) const
+{
+    writeNumber(out, quint64(row));
+}
+
+AddRowCommand* AddRowCommand::read(QDataStream& in, CatalogModel* model)
+{
+    return new AddRowCommand(model, int(readNumber(in)));
+}
+
+void RemoveRowsCommand::write(QDataStream& out) const
+{
+    writeNumber(out, quint64(rowsToRemove.size()));
+    int previous = 0;
+    for (int i = 0; i < rowsToRemove.size(); ++i)
     {
-        model->removeRow(r);
+        writeDelta(out, rowsToRemove[i] - previous);
+        previous = rowsToRemove[i];
+        writeNumber(out, quint64(backup[i].size()));
+        for (const QVariant& value : backup[i])
+            writeText(out, value.toString());
     }
-}
\ No newline at end of file
+}
+
+RemoveRowsCommand* RemoveRowsCommand::read(QDataStream& in, CatalogModel* model)
+{
+    const quint64 n = readNumber(in);
+    if (!in.device() || n > quint64(in.device()->bytesAvailable()))
+    {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return nullptr;
+    }
+    QVector<int> rows(qsizetype(n));
+    QVector<QVector<QVariant>> removed(qsizetype(n));
+    int previous = 0;
+    for (quint64 i = 0; i < n && in.status() == QDataStream::Ok; ++i)
+    {
+        rows[i] = previous + int(readDelta(in));
+        previous = rows[i];
+        const quint64 columns = readNumber(in);
+        if (columns > CatalogModel::ColumnCount)
+            in.setStatus(QDataStream::ReadCorruptData);
+        for (quint64 c = 0; c < columns && in.status() == QDataStream::Ok; ++c)
+            removed[i] << readText(in);
+    }
+    return new RemoveRowsCommand(model, rows, removed);
+}
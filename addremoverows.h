@@ -4,22 +4,35 @@
 #include <QUndoCommand>
 #include <QStandardItem>
 
-class AddRowCommand : public QUndoCommand {
+#include "catalogmodel.h"
+#include "historycommand.h"
+
+class AddRowCommand : public HistoryCommand {
 public:
-    AddRowCommand(QStandardItemModel* m);
+    AddRowCommand(CatalogModel* m);
+    AddRowCommand(CatalogModel* m, int row);
     void undo() override;
     void redo() override;
+
+    Type type() const override { return AddRow; }
+    void write(QDataStream& out) const override;
+    static AddRowCommand* read(QDataStream& in, CatalogModel* model);
 private:
-    QStandardItemModel* model;
+    CatalogModel*       model;
     int                 row;
 };
 
-class RemoveRowsCommand : public QUndoCommand {
+class RemoveRowsCommand : public HistoryCommand {
 public:
     RemoveRowsCommand(QStandardItemModel* m, const QVector<int>& rows);
+    RemoveRowsCommand(QStandardItemModel* m, const QVector<int>& rows, const QVector<QVector<QVariant>>& removed);
     
     void undo() override;
     void redo() override;
+
+    Type type() const override { return RemoveRows; }
+    void write(QDataStream& out) const override;
+    static RemoveRowsCommand* read(QDataStream& in, CatalogModel* model);
 private:
     QStandardItemModel*         model;
     QVector<int>                rowsToRemove;
@@ -0,0 +1,230 @@
+#include "authorgroupmodel.h"
+
+#include <algorithm>
+
+AuthorGroupModel::AuthorGroupModel(CatalogModel* catalog, AuthorIndex* index, QObject* parent)
+    : QAbstractItemModel(parent)
+    , m_catalog(catalog)
+    , m_index(index)
+{
+    connect(m_index, &AuthorIndex::rowAdded,   this, &AuthorGroupModel::onRowAdded);
+    connect(m_index, &AuthorIndex::rowRemoved, this, &AuthorGroupModel::onRowRemoved);
+    connect(m_index, &AuthorIndex::reset,      this, &AuthorGroupModel::rebuild);
+    rebuild();
+}
+
+// Top-level indexes carry internalId 0, books carry (author id + 1).
+QModelIndex AuthorGroupModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (column != 0 || row < 0)
+        return QModelIndex();
+    if (!parent.isValid())
+        return row < m_groups.size() ? createIndex(row, 0, quintptr(0)) : QModelIndex();
+    if (parent.internalId() != 0)
+        return QModelIndex();
+
+    const Group& g = m_groups[parent.row()];
+    return row < g.fetched ? createIndex(row, 0, quintptr(g.authorId + 1)) : QModelIndex();
+}
+
+QModelIndex AuthorGroupModel::parent(const QModelIndex& child) const
+{
+    if (!child.isValid() || child.internalId() == 0)
+        return QModelIndex();
+    const int row = m_groupRow.value(int(child.internalId()) - 1, -1);
+    return row < 0 ? QModelIndex() : createIndex(row, 0, quintptr(0));
+}
+
+int AuthorGroupModel::rowCount(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return m_groups.size();
+    if (parent.internalId() != 0)
+        return 0;
+    return m_groups[parent.row()].fetched;
+}
+
+int AuthorGroupModel::columnCount(const QModelIndex&) const
+{
+    return 1;
+}
+
+bool AuthorGroupModel::hasChildren(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return !m_groups.isEmpty();
+    return parent.internalId() == 0;
+}
+
+QVariant AuthorGroupModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    if (index.internalId() == 0)
+    {
+        const int id = m_groups[index.row()].authorId;
+        return QString("%1 (%2)").arg(m_catalog->authors().name(id)).arg(m_index->count(id));
+    }
+
+    const int row = sourceRow(index);
+    const QStandardItem* name = row < 0 ? nullptr : m_catalog->item(row, CatalogModel::NameColumn);
+    return name ? name->text() : QString();
+}
+
+bool AuthorGroupModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid() || parent.internalId() != 0)
+        return false;
+    const Group& g = m_groups[parent.row()];
+    const int total = g.pulled ? g.books.size() : m_index->count(g.authorId);
+    return g.fetched < total;
+}
+
+void AuthorGroupModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    Group& g = m_groups[parent.row()];
+    if (!g.pulled)
+    {
+        const QSet<QStandardItem*>& rows = m_index->rows(g.authorId);
+        g.books = QVector<QStandardItem*>(rows.begin(), rows.end());
+        std::sort(g.books.begin(), g.books.end(),
+                  [](QStandardItem* a, QStandardItem* b) { return a->row() < b->row(); });
+        g.pulled = true;
+    }
+
+    const int n = qMin(FetchBatch, int(g.books.size()) - g.fetched);
+    beginInsertRows(parent, g.fetched, g.fetched + n - 1);
+    g.fetched += n;
+    endInsertRows();
+}
+
+int AuthorGroupModel::authorId(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return -1;
+    if (index.internalId() == 0)
+        return m_groups[index.row()].authorId;
+    return int(index.internalId()) - 1;
+}
+
+int AuthorGroupModel::sourceRow(const QModelIndex& index) const
+{
+    if (!index.isValid() || index.internalId() == 0)
+        return -1;
+    const int gr = m_groupRow.value(int(index.internalId()) - 1, -1);
+    if (gr < 0 || index.row() >= m_groups[gr].fetched)
+        return -1;
+    return m_groups[gr].books[index.row()]->row();
+}
+
+void AuthorGroupModel::onRowAdded(int authorId, QStandardItem* item)
+{
+    const int gr = m_groupRow.value(authorId, -1);
+    if (gr < 0)
+    {
+        // New authors go where rebuild() would have sorted them.
+        const AuthorPool& pool = m_catalog->authors();
+        const QString name = pool.name(authorId);
+        const auto at = std::lower_bound(m_groups.cbegin(), m_groups.cend(), name,
+                                         [&pool](const Group& g, const QString& n) {
+            return QString::localeAwareCompare(pool.name(g.authorId), n) < 0;
+        });
+        const int row = int(at - m_groups.cbegin());
+        beginInsertRows(QModelIndex(), row, row);
+        Group g;
+        g.authorId = authorId;
+        m_groups.insert(row, g);
+        renumber(row);
+        endInsertRows();
+        return;
+    }
+
+    Group& g = m_groups[gr];
+    const QModelIndex groupIndex = index(gr, 0);
+    if (g.pulled)
+    {
+        // A fully expanded group shows the new book straight away; a partly
+        // fetched one picks it up with its next batch.
+        if (g.fetched == g.books.size())
+        {
+            beginInsertRows(groupIndex, g.fetched, g.fetched);
+            g.books.append(item);
+            ++g.fetched;
+            endInsertRows();
+        }
+        else
+        {
+            g.books.append(item);
+        }
+    }
+    emit dataChanged(groupIndex, groupIndex);
+}
+
+void AuthorGroupModel::onRowRemoved(int authorId, QStandardItem* item)
+{
+    const int gr = m_groupRow.value(authorId, -1);
+    if (gr < 0)
+        return;
+
+    if (m_index->count(authorId) == 0)
+    {
+        beginRemoveRows(QModelIndex(), gr, gr);
+        m_groups.remove(gr);
+        m_groupRow.remove(authorId);
+        renumber(gr);
+        endRemoveRows();
+        return;
+    }
+
+    Group& g = m_groups[gr];
+    const QModelIndex groupIndex = index(gr, 0);
+    if (g.pulled)
+    {
+        const int pos = g.books.indexOf(item);
+        if (pos >= 0 && pos < g.fetched)
+        {
+            beginRemoveRows(groupIndex, pos, pos);
+            g.books.remove(pos);
+            --g.fetched;
+            endRemoveRows();
+        }
+        else if (pos >= 0)
+        {
+            g.books.remove(pos);
+        }
+    }
+    emit dataChanged(groupIndex, groupIndex);
+}
+
+void AuthorGroupModel::rebuild()
+{
+    beginResetModel();
+    m_groups.clear();
+    m_groupRow.clear();
+
+    QList<int> ids = m_index->authors();
+    const AuthorPool& pool = m_catalog->authors();
+    std::sort(ids.begin(), ids.end(), [&pool](int a, int b) {
+        return QString::localeAwareCompare(pool.name(a), pool.name(b)) < 0;
+    });
+
+    m_groups.reserve(ids.size());
+    for (int id : ids)
+    {
+        Group g;
+        g.authorId = id;
+        m_groups.append(g);
+    }
+    renumber(0);
+    endResetModel();
+}
+
+void AuthorGroupModel::renumber(int from)
+{
+    for (int row = from; row < m_groups.size(); ++row)
+        m_groupRow.insert(m_groups[row].authorId, row);
+}
@@ -0,0 +1,54 @@
+#ifndef AUTHORGROUPMODEL_H
+#define AUTHORGROUPMODEL_H
+
+#include <QAbstractItemModel>
+#include <QVector>
+#include <QHash>
+
+#include "authorindex.h"
+
+// Two-level author -> books tree over AuthorIndex. Authors are listed up
+// front; a group's books are handed to the view in batches through
+// canFetchMore()/fetchMore(), only once the group is expanded.
+class AuthorGroupModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    AuthorGroupModel(CatalogModel* catalog, AuthorIndex* index, QObject* parent = nullptr);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    int authorId(const QModelIndex& index) const;   // group or book index
+    int sourceRow(const QModelIndex& index) const;  // book index, -1 otherwise
+
+private:
+    struct Group
+    {
+        int                     authorId = -1;
+        bool                    pulled   = false;   // books copied from the index
+        int                     fetched  = 0;       // books exposed to the view
+        QVector<QStandardItem*> books;
+    };
+
+    static constexpr int FetchBatch = 256;
+
+    void onRowAdded(int authorId, QStandardItem* item);
+    void onRowRemoved(int authorId, QStandardItem* item);
+    void rebuild();
+    void renumber(int from);
+
+    CatalogModel*       m_catalog;
+    AuthorIndex*        m_index;
+    QVector<Group>      m_groups;
+    QHash<int, int>     m_groupRow;     // author id -> top-level row
+};
+
+#endif // AUTHORGROUPMODEL_H
@@ -0,0 +1,82 @@
+#include "authorindex.h"
+
+#include <QSignalBlocker>
+
+AuthorIndex::AuthorIndex(CatalogModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+{
+    connect(m_model, &CatalogModel::rowAboutToChange, this, &AuthorIndex::onRowAboutToChange);
+    connect(m_model, &CatalogModel::rowChanged,       this, &AuthorIndex::onRowChanged);
+    connect(m_model, &QAbstractItemModel::rowsInserted,
+            this, &AuthorIndex::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &AuthorIndex::onRowsAboutToBeRemoved);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &AuthorIndex::rebuild);
+    rebuild();
+}
+
+const QSet<QStandardItem*>& AuthorIndex::rows(int authorId) const
+{
+    static const QSet<QStandardItem*> empty;
+    auto it = m_rows.constFind(authorId);
+    return it != m_rows.constEnd() ? it.value() : empty;
+}
+
+void AuthorIndex::rebuild()
+{
+    {
+        const QSignalBlocker blocker(this);
+        m_rows.clear();
+        for (int r = 0; r < m_model->rowCount(); ++r)
+            add(r);
+    }
+    emit reset();
+}
+
+void AuthorIndex::add(int row)
+{
+    const int id = m_model->authorId(row);
+    if (id < 0) return;
+    QStandardItem* item = m_model->item(row, CatalogModel::AuthorColumn);
+    m_rows[id].insert(item);
+    emit rowAdded(id, item);
+}
+
+void AuthorIndex::remove(int row)
+{
+    const int id = m_model->authorId(row);
+    if (id < 0) return;
+    QStandardItem* item = m_model->item(row, CatalogModel::AuthorColumn);
+    auto it = m_rows.find(id);
+    if (it == m_rows.end() || !it.value().remove(item)) return;
+    if (it.value().isEmpty())
+        m_rows.erase(it);
+    emit rowRemoved(id, item);
+}
+
+void AuthorIndex::onRowAboutToChange(int row, int column)
+{
+    if (column == CatalogModel::AuthorColumn)
+        remove(row);
+}
+
+void AuthorIndex::onRowChanged(int row, int column)
+{
+    if (column == CatalogModel::AuthorColumn)
+        add(row);
+}
+
+void AuthorIndex::onRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    for (int r = first; r <= last; ++r)
+        add(r);
+}
+
+void AuthorIndex::onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    for (int r = first; r <= last; ++r)
+        remove(r);
+}
@@ -0,0 +1,43 @@
+#ifndef AUTHORINDEX_H
+#define AUTHORINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+
+#include "catalogmodel.h"
+
+// Author id -> Author-column items of the rows written by that author.
+// Items rather than row numbers are stored, so inserting or removing rows
+// elsewhere never has to renumber the index; item->row() gives the row back.
+class AuthorIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AuthorIndex(CatalogModel* model, QObject* parent = nullptr);
+
+    const QSet<QStandardItem*>& rows(int authorId) const;
+    int  count(int authorId) const     { return rows(authorId).size(); }
+    QList<int> authors() const         { return m_rows.keys(); }
+
+    void rebuild();
+
+signals:
+    void rowAdded(int authorId, QStandardItem* item);
+    void rowRemoved(int authorId, QStandardItem* item);
+    void reset();
+
+private:
+    void add(int row);
+    void remove(int row);
+    void onRowAboutToChange(int row, int column);
+    void onRowChanged(int row, int column);
+    void onRowsInserted(const QModelIndex& parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+
+    CatalogModel*                       m_model;
+    QHash<int, QSet<QStandardItem*>>    m_rows;
+};
+
+#endif // AUTHORINDEX_H
@@ -0,0 +1,54 @@
+#include "authorpool.h"
+
+int AuthorPool::intern(const QString& name)
+{
+    auto it = m_ids.constFind(name);
+    if (it != m_ids.constEnd())
+        return it.value();
+
+    const int id = m_names.size();
+    m_names.append(name);
+    m_refs.append(0);
+    m_ids.insert(m_names.last(), id);
+    return id;
+}
+
+int AuthorPool::find(const QString& name) const
+{
+    return m_ids.value(name, -1);
+}
+
+void AuthorPool::retain(int id)
+{
+    if (contains(id))
+        ++m_refs[id];
+}
+
+void AuthorPool::release(int id)
+{
+    if (contains(id) && m_refs[id] > 0)
+        --m_refs[id];
+}
+
+void AuthorPool::clear()
+{
+    m_ids.clear();
+    m_names.clear();
+    m_refs.clear();
+}
+
+AuthorPool::Stats AuthorPool::stats() const
+{
+    Stats s;
+    s.distinct = m_names.size();
+    for (int id = 0; id < m_names.size(); ++id)
+    {
+        const qint64 bytes = qint64(m_names[id].size()) * qint64(sizeof(QChar));
+        s.pooledBytes += bytes;
+        if (m_refs[id] == 0) continue;
+        ++s.live;
+        s.references += m_refs[id];
+        s.savedBytes += bytes * (m_refs[id] - 1);
+    }
+    return s;
+}
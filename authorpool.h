@@ -0,0 +1,42 @@
+#ifndef AUTHORPOOL_H
+#define AUTHORPOOL_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+
+// Interns author names so every cell referring to the same author shares
+// one QString and can be compared by id instead of by text.
+class AuthorPool
+{
+public:
+    struct Stats
+    {
+        int     distinct   = 0;   // ids handed out since the last clear()
+        int     live       = 0;   // ids still referenced by at least one cell
+        qint64  references = 0;   // cells pointing into the pool
+        qint64  pooledBytes = 0;  // bytes held by the pool itself
+        qint64  savedBytes  = 0;  // bytes the cells would hold without interning
+    };
+
+    int  intern(const QString& name);
+    int  find(const QString& name) const;
+
+    const QString& name(int id) const   { return m_names[id]; }
+    int  size() const                   { return m_names.size(); }
+    bool contains(int id) const         { return id >= 0 && id < m_names.size(); }
+    int  references(int id) const       { return contains(id) ? m_refs[id] : 0; }
+
+    void retain(int id);
+    void release(int id);
+    void clear();
+
+    Stats stats() const;
+
+private:
+    QHash<QString, int>  m_ids;
+    QVector<QString>     m_names;
+    QVector<int>         m_refs;
+};
+
+#endif // AUTHORPOOL_H
@@ -0,0 +1,136 @@
+#include "cachedtextdelegate.h"
+
+#include <QPainter>
+#include <QApplication>
+#include <QStyle>
+#include <QFontMetricsF>
+
+CachedTextDelegate::CachedTextDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void CachedTextDelegate::clearCache()
+{
+    m_cache.clear();
+}
+
+void CachedTextDelegate::setFont(const QFont& font) const
+{
+    m_font    = font;
+    m_fontSet = true;
+    m_cache.clear();
+
+    const QFontMetricsF fm(font);
+    m_lineHeight = fm.height();
+    for (int d = 0; d < 10; ++d)
+    {
+        const QChar digit('0' + d);
+        m_digits[d] = QStaticText(QString(digit));
+        m_digits[d].setTextFormat(Qt::PlainText);
+        m_digits[d].prepare(QTransform(), font);
+        m_digitWidth[d] = fm.horizontalAdvance(digit);
+    }
+}
+
+const QStaticText& CachedTextDelegate::shaped(const QString& text) const
+{
+    auto it = m_cache.find(text);
+    if (it != m_cache.end())
+        return it.value();
+
+    if (m_cache.size() >= MaxCached)
+        m_cache.clear();
+    QStaticText st(text);
+    st.setTextFormat(Qt::PlainText);
+    st.setPerformanceHint(QStaticText::AggressiveCaching);
+    st.prepare(QTransform(), m_font);
+    return m_cache.insert(text, st).value();
+}
+
+bool CachedTextDelegate::drawDigits(QPainter* painter, const QRect& rect, const QString& text) const
+{
+    qreal width = 0;
+    for (const QChar c : text)
+    {
+        const ushort u = c.unicode();
+        if (u < '0' || u > '9')
+            return false;
+        width += m_digitWidth[u - '0'];
+    }
+    if (width > rect.width())
+        return false;
+
+    QPointF pos(rect.right() + 1 - width, rect.top() + (rect.height() - m_lineHeight) / 2);
+    for (const QChar c : text)
+    {
+        const int d = c.unicode() - '0';
+        painter->drawStaticText(pos, m_digits[d]);
+        pos.rx() += m_digitWidth[d];
+    }
+    return true;
+}
+
+void CachedTextDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const QWidget* widget = option.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+
+    // Selection and hover backgrounds come from the style as usual. When the
+    // view has not put the cell's index in the option, it goes into one
+    // reused option rather than a fresh copy per cell.
+    const QStyleOptionViewItem* panel = &option;
+    if (option.index != index)
+    {
+        m_option = option;
+        m_option.index = index;
+        panel = &m_option;
+    }
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, panel, painter, widget);
+
+    const QString text = index.data(Qt::DisplayRole).toString();
+    if (!text.isEmpty())
+    {
+        if (!m_fontSet || option.font != m_font)
+            setFont(option.font);
+
+        const QPalette::ColorGroup group = !(option.state & QStyle::State_Enabled) ? QPalette::Disabled
+                                         : (option.state & QStyle::State_Active)   ? QPalette::Active
+                                                                                   : QPalette::Inactive;
+        const QPalette::ColorRole role = (option.state & QStyle::State_Selected) ? QPalette::HighlightedText
+                                                                                 : QPalette::Text;
+        // Pen and font are left for the next cell, which mostly wants the
+        // same ones; they are only set when they differ.
+        const QColor& color = option.palette.color(group, role);
+        if (painter->pen().color() != color || painter->pen().style() != Qt::SolidLine)
+            painter->setPen(color);
+        if (painter->font() != m_font)
+            painter->setFont(m_font);
+
+        const QRect r = option.rect.adjusted(Margin, 0, -Margin, 0);
+        if (!m_numeric || !drawDigits(painter, r, text))
+        {
+            const QStaticText& st = shaped(text);
+            const QSizeF size = st.size();
+            if (size.width() <= r.width())
+            {
+                const qreal x = m_numeric ? r.right() + 1 - size.width() : r.left();
+                painter->drawStaticText(QPointF(x, r.top() + (r.height() - size.height()) / 2), st);
+            }
+            else
+            {
+                const Qt::Alignment align = Qt::AlignVCenter | (m_numeric ? Qt::AlignRight : Qt::AlignLeft);
+                painter->drawText(r, align, option.fontMetrics.elidedText(text, Qt::ElideRight, r.width()));
+            }
+        }
+    }
+
+    if (option.state & QStyle::State_HasFocus)
+    {
+        QStyleOptionFocusRect focus;
+        focus.QStyleOption::operator=(option);
+        focus.state |= QStyle::State_KeyboardFocusChange;
+        focus.backgroundColor = option.palette.color(QPalette::Window);
+        style->drawPrimitive(QStyle::PE_FrameFocusRect, &focus, painter, widget);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef CACHEDTEXTDELEGATE_H
+#define CACHEDTEXTDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QStaticText>
+#include <QHash>
+#include <QFont>
+
+// Paints plain text cells from shaped text cached by content. Only the
+// display string is read from the model (no style-option setup), its
+// QStaticText is laid out once and reused on every repaint and scroll.
+// Numeric columns are right-aligned and drawn from ten pre-shaped digits,
+// so page counts need no cache entries at all. Text that does not fit
+// falls back to an elided drawText(). Editing is left to
+// QStyledItemDelegate.
+class CachedTextDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit CachedTextDelegate(QObject* parent = nullptr);
+
+    void setNumeric(bool on)    { m_numeric = on; }
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+public slots:
+    void clearCache();
+
+private:
+    static constexpr int Margin    = 3;
+    static constexpr int MaxCached = 8192;
+
+    void setFont(const QFont& font) const;
+    const QStaticText& shaped(const QString& text) const;
+    bool drawDigits(QPainter* painter, const QRect& rect, const QString& text) const;
+
+    bool                                m_numeric = false;
+    mutable QFont                       m_font;
+    mutable bool                        m_fontSet = false;
+    mutable qreal                       m_lineHeight = 0;
+    mutable QStaticText                 m_digits[10];
+    mutable qreal                       m_digitWidth[10] = {};
+    mutable QHash<QString, QStaticText> m_cache;
+    mutable QStyleOptionViewItem        m_option;
+};
+
+#endif // CACHEDTEXTDELEGATE_H
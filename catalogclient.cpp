@@ -0,0 +1,183 @@
+#include "catalogclient.h"
+
+#include <QDeadlineTimer>
+
+using namespace CatalogProtocol;
+
+CatalogClient::CatalogClient(QObject* parent)
+    : QObject(parent)
+{
+    connect(&m_socket, &QLocalSocket::readyRead, this, &CatalogClient::read);
+    connect(&m_socket, &QLocalSocket::errorOccurred, this, [this]() { emit failed(m_socket.errorString()); });
+}
+
+bool CatalogClient::connectToServer(const QString& name, int msecs)
+{
+    m_socket.connectToServer(name);
+    return m_socket.waitForConnected(msecs);
+}
+
+void CatalogClient::disconnectFromServer()
+{
+    flush();
+    m_socket.disconnectFromServer();
+    m_ops.clear();
+    m_in.clear();
+    m_offset = 0;
+}
+
+quint32 CatalogClient::send(Op op, const QByteArray& body)
+{
+    const quint32 id = m_nextId++;
+    QByteArray payload;
+    {
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << id << quint8(op);
+    }
+    payload += body;
+    appendFrame(m_out, payload);
+    m_ops.insert(id, op);
+    if (m_out.size() >= FlushBytes)
+        flush();
+    return id;
+}
+
+quint32 CatalogClient::count()
+{
+    return send(Count, QByteArray());
+}
+
+quint32 CatalogClient::query(const QString& text, int limit)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << text << qint32(limit);
+    return send(Query, body);
+}
+
+quint32 CatalogClient::lookup(const QVector<qint32>& rows)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << qint32(rows.size());
+    for (qint32 row : rows)
+        out << row;
+    return send(Lookup, body);
+}
+
+quint32 CatalogClient::insert(const QVector<Row>& rows)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << qint32(rows.size());
+    for (const Row& row : rows)
+        out << row;
+    return send(Insert, body);
+}
+
+void CatalogClient::flush()
+{
+    if (m_out.isEmpty() || !isConnected()) return;
+    m_socket.write(m_out);
+    m_out.clear();
+    m_socket.flush();
+}
+
+void CatalogClient::read()
+{
+    m_in += m_socket.readAll();
+    QByteArray payload;
+    bool tooLarge = false;
+    while (takeFrame(m_in, m_offset, &payload, &tooLarge))
+        decode(payload);
+    m_in.remove(0, m_offset);
+    m_offset = 0;
+
+    if (tooLarge)
+    {
+        m_socket.abort();
+        emit failed(tr("Oversized reply from the server"));
+    }
+}
+
+void CatalogClient::decode(const QByteArray& payload)
+{
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    Reply r;
+    quint8 status = 0;
+    in >> r.id >> status;
+    const quint8 op = m_ops.take(r.id);
+    r.ok = status == Ok;
+
+    if (!r.ok)
+        in >> r.error;
+    else if (op == Count)
+        in >> r.value;
+    else if (op == Insert)
+        in >> r.value >> r.inserted;
+    else if (op == Query || op == Lookup)
+    {
+        qint32 n = 0;
+        if (op == Query)
+            in >> r.value;
+        in >> n;
+        // Each row takes its number and three string lengths, so the count
+        // is checked against the payload before anything is allocated.
+        if (n < 0 || n > payload.size() / (4 + MinRowBytes))
+            n = 0;
+        r.rows.resize(n);
+        r.data.resize(n);
+        for (qint32 i = 0; i < n; ++i)
+            in >> r.rows[i] >> r.data[i];
+    }
+    if (r.ok && in.status() != QDataStream::Ok)
+    {
+        r.ok = false;
+        r.error = tr("Malformed reply");
+    }
+
+    m_replies.insert(r.id, r);
+    emit replied(r.id);
+}
+
+bool CatalogClient::waitForReply(quint32 id, int msecs)
+{
+    flush();
+    if (m_socket.bytesAvailable() > 0)
+        read();
+    const QDeadlineTimer deadline(msecs);
+    while (!m_replies.contains(id))
+    {
+        if (!m_ops.contains(id) || !isConnected())
+            return false;
+        if (!m_socket.waitForReadyRead(int(deadline.remainingTime())))
+            return false;
+    }
+    return true;
+}
+
+bool CatalogClient::waitForReplies(int msecs)
+{
+    flush();
+    const QDeadlineTimer deadline(msecs);
+    while (!m_ops.isEmpty())
+    {
+        if (!isConnected() || !m_socket.waitForReadyRead(int(deadline.remainingTime())))
+            return false;
+    }
+    return true;
+}
+
+bool CatalogClient::takeReply(quint32 id, Reply* reply)
+{
+    auto it = m_replies.find(id);
+    if (it == m_replies.end()) return false;
+    *reply = it.value();
+    m_replies.erase(it);
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef CATALOGCLIENT_H
+#define CATALOGCLIENT_H
+
+#include <QObject>
+#include <QLocalSocket>
+#include <QHash>
+#include <QVector>
+
+#include "catalogprotocol.h"
+
+// Client side of catalogprotocol.h for other programs. Depends only on
+// QtCore and QtNetwork. Every request returns an id immediately and is
+// buffered until flush(), a wait or 64 KB of pending output, so callers can
+// keep many requests in flight over one connection. Replies are kept until
+// taken with takeReply().
+class CatalogClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Reply
+    {
+        quint32                          id = 0;
+        bool                             ok = false;
+        QString                          error;
+        qint32                           value = 0;   // Count: rows, Query: total matches, Insert: first row
+        qint32                           inserted = 0;
+        QVector<qint32>                  rows;        // Query, Lookup
+        QVector<CatalogProtocol::Row>    data;
+    };
+
+    explicit CatalogClient(QObject* parent = nullptr);
+
+    bool connectToServer(const QString& name = QString::fromLatin1(CatalogProtocol::DefaultServerName), int msecs = 3000);
+    void disconnectFromServer();
+    bool isConnected() const    { return m_socket.state() == QLocalSocket::ConnectedState; }
+    QString errorString() const { return m_socket.errorString(); }
+
+    quint32 count();
+    quint32 query(const QString& text, int limit);
+    quint32 lookup(const QVector<qint32>& rows);
+    quint32 insert(const QVector<CatalogProtocol::Row>& rows);
+
+    void flush();
+    bool waitForReply(quint32 id, int msecs = 30000);
+    bool waitForReplies(int msecs = 30000);
+    bool takeReply(quint32 id, Reply* reply);
+    int  inFlight() const       { return m_ops.size(); }
+
+signals:
+    void replied(quint32 id);
+    void failed(const QString& error);
+
+private:
+    static constexpr int FlushBytes = 64 * 1024;
+
+    quint32 send(CatalogProtocol::Op op, const QByteArray& body);
+    void read();
+    void decode(const QByteArray& payload);
+
+    QLocalSocket                m_socket;
+    quint32                     m_nextId = 1;
+    QByteArray                  m_out;
+    QByteArray                  m_in;
+    int                         m_offset = 0;
+    QHash<quint32, quint8>      m_ops;
+    QHash<quint32, Reply>       m_replies;
+};
+
+#endif // CATALOGCLIENT_H
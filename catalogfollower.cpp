@@ -0,0 +1,284 @@
+#include "catalogfollower.h"
+#include "loghandler.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+
+const int    BoundaryMask  = 63;        // a chunk ends on ~1 line in 64
+const qint64 MaxChunkBytes = 1 << 20;
+
+int lineEnd(const QByteArray& data, int from, int to)
+{
+    while (to > from && (data[to - 1] == '\n' || data[to - 1] == '\r'))
+        --to;
+    return to;
+}
+
+QStringList parseLine(const QByteArray& data, int from, int to)
+{
+    to = lineEnd(data, from, to);
+    if (to == from)
+        return QStringList();
+    QStringList fields = QString::fromUtf8(data.constData() + from, to - from).split('\t');
+    while (fields.size() < CatalogModel::ColumnCount)
+        fields << QString();
+    return fields;
+}
+
+} // namespace
+
+CatalogFollower::CatalogFollower(CatalogModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+{
+    // Writers usually touch the file several times in a row.
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(150);
+    connect(&m_debounce, &QTimer::timeout, this, &CatalogFollower::reload);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, &m_debounce, qOverload<>(&QTimer::start));
+
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &CatalogFollower::onRowsMoved);
+    connect(m_model, &QAbstractItemModel::rowsRemoved,  this, &CatalogFollower::onRowsMoved);
+    connect(m_model, &QAbstractItemModel::modelReset,   this, &CatalogFollower::onRowsMoved);
+}
+
+// Without unsaved edits the model holds exactly what was last read or saved.
+void CatalogFollower::setLocalEdits(bool on)
+{
+    m_localEdits = on;
+    if (!on)
+        m_shifted = false;
+}
+
+void CatalogFollower::onRowsMoved()
+{
+    if (!m_merging)
+        m_shifted = true;
+}
+
+void CatalogFollower::follow(const QString& path)
+{
+    stop();
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+    {
+        qDebug(logWarning()) << "Cannot follow" << path << ":" << f.errorString();
+        return;
+    }
+    const QByteArray data = f.readAll();
+    m_path   = path;
+    m_size   = data.size();
+    m_chunks = split(data, 0);
+    m_shifted = false;
+    m_watcher.addPath(path);
+    qDebug(logInfo()) << "Following" << path << "in" << m_chunks.size() << "chunks.";
+}
+
+void CatalogFollower::stop()
+{
+    if (!m_watcher.files().isEmpty())
+        m_watcher.removePaths(m_watcher.files());
+    m_debounce.stop();
+    m_path.clear();
+    m_chunks.clear();
+    m_size = 0;
+}
+
+QVector<CatalogFollower::Chunk> CatalogFollower::split(const QByteArray& data, qint64 base)
+{
+    QVector<Chunk> chunks;
+    Chunk cur { 0, base, 0, 0 };
+    int pos = 0;
+    while (pos < data.size())
+    {
+        const int nl  = data.indexOf('\n', pos);
+        const int end = nl < 0 ? data.size() : nl + 1;
+        const quint64 h = qHash(QByteArrayView(data.constData() + pos, end - pos));
+
+        cur.hash   = (cur.hash ^ h) * 0x100000001b3ULL;
+        cur.bytes += end - pos;
+        const int textEnd = lineEnd(data, pos, end);
+        if (textEnd > pos)
+        {
+            ++cur.rows;
+            cur.lines.append(quint32(qHash(QByteArrayView(data.constData() + pos, textEnd - pos))));
+        }
+        pos = end;
+
+        if (nl >= 0 && ((h & BoundaryMask) == 0 || cur.bytes >= MaxChunkBytes))
+        {
+            chunks.append(cur);
+            cur = Chunk { 0, base + pos, 0, 0 };
+        }
+    }
+    if (cur.bytes > 0)
+        chunks.append(cur);
+    return chunks;
+}
+
+void CatalogFollower::reload()
+{
+    if (m_path.isEmpty()) return;
+
+    // Editors that save by renaming replace the inode and drop the watch.
+    if (!m_watcher.files().contains(m_path) && QFileInfo::exists(m_path))
+        m_watcher.addPath(m_path);
+
+    QFile f(m_path);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+
+    const qint64 size = f.size();
+    if (size > m_size && !m_chunks.isEmpty())
+    {
+        // Likely an append: if the old last chunk is intact only it and the
+        // new bytes are read.
+        const Chunk last = m_chunks.last();
+        f.seek(last.offset);
+        const QByteArray tail = f.readAll();
+        const QVector<Chunk> check = split(tail.left(last.bytes), last.offset);
+        if (check.size() == 1 && check[0].hash == last.hash && check[0].bytes == last.bytes)
+        {
+            QVector<Chunk> fresh = m_chunks.mid(0, m_chunks.size() - 1);
+            fresh += split(tail, last.offset);
+            merge(fresh, tail, last.offset);
+            m_size = size;
+            return;
+        }
+    }
+
+    f.seek(0);
+    const QByteArray data = f.readAll();
+    merge(split(data, 0), data, 0);
+    m_size = data.size();
+}
+
+void CatalogFollower::merge(const QVector<Chunk>& fresh, const QByteArray& data, qint64 base)
+{
+    const auto same = [](const Chunk& a, const Chunk& b) { return a.hash == b.hash && a.bytes == b.bytes; };
+
+    int head = 0;
+    while (head < m_chunks.size() && head < fresh.size() && same(m_chunks[head], fresh[head]))
+        ++head;
+    int tail = 0;
+    while (tail < m_chunks.size() - head && tail < fresh.size() - head
+           && same(m_chunks[m_chunks.size() - 1 - tail], fresh[fresh.size() - 1 - tail]))
+        ++tail;
+
+    int startRow = 0, oldRows = 0, totalRows = 0;
+    QVector<quint32> oldLines;
+    for (int i = 0; i < m_chunks.size(); ++i)
+    {
+        if (i < head)
+            startRow += m_chunks[i].rows;
+        else if (i < m_chunks.size() - tail)
+            oldLines += m_chunks[i].lines;
+        totalRows += m_chunks[i].rows;
+    }
+    QVector<quint32> newLines;
+    for (int i = head; i < fresh.size() - tail; ++i)
+        newLines += fresh[i].lines;
+
+    // Narrow the changed chunks down to the rows whose text differs; chunk
+    // boundaries move with any edit, so whole chunks overstate the change.
+    int prefix = 0;
+    while (prefix < oldLines.size() && prefix < newLines.size() && oldLines[prefix] == newLines[prefix])
+        ++prefix;
+    int suffix = 0;
+    while (suffix < oldLines.size() - prefix && suffix < newLines.size() - prefix
+           && oldLines[oldLines.size() - 1 - suffix] == newLines[newLines.size() - 1 - suffix])
+        ++suffix;
+    oldRows = int(oldLines.size()) - prefix - suffix;
+    const int newRows = int(newLines.size()) - prefix - suffix;
+    startRow += prefix;
+
+    if (oldRows == 0 && newRows == 0)
+    {
+        m_chunks = fresh;
+        return;     // nothing changed
+    }
+
+    // Rows past the old end go to the end of the model, wherever local edits
+    // have left it; anything else needs file rows to still be model rows.
+    const bool appended = oldRows == 0 && startRow == totalRows;
+    const bool inPlace  = oldRows > 0;
+    if ((inPlace && m_localEdits) || (!appended && m_shifted)
+        || m_model->rowCount() < startRow + oldRows)
+    {
+        qDebug(logWarning()) << "File changed before its end while the catalog has local edits; not merged.";
+        emit conflict();
+        return;
+    }
+    const int modelRow = appended ? m_model->rowCount() : startRow;
+
+    QVector<QStringList> rows;
+    QStringList lines;
+    int fileRow = 0;
+    for (int i = head; i < fresh.size() - tail && rows.size() < newRows; ++i)
+    {
+        const int from = int(fresh[i].offset - base);
+        const int to   = from + int(fresh[i].bytes);
+        for (int pos = from; pos < to && rows.size() < newRows; )
+        {
+            const int nl  = data.indexOf('\n', pos);
+            const int end = (nl < 0 || nl >= to) ? to : nl + 1;
+            const QStringList fields = parseLine(data, pos, end);
+            if (!fields.isEmpty() && fileRow++ >= prefix)
+            {
+                rows.append(fields);
+                lines.append(QString::fromUtf8(data.constData() + pos, lineEnd(data, pos, end) - pos));
+            }
+            pos = end;
+        }
+    }
+
+    m_merging = true;
+    const int overlap = qMin(oldRows, newRows);
+    QVector<CatalogModel::CellChange> changes;
+    for (int i = 0; i < overlap; ++i)
+    {
+        const int r = modelRow + i;
+        for (int c = 0; c < CatalogModel::ColumnCount; ++c)
+        {
+            const QStandardItem* it = m_model->item(r, c);
+            const QString before = it ? it->text() : QString();
+            if (before != rows[i][c])
+                changes.append({ r, c, before, rows[i][c] });
+        }
+    }
+    m_model->applyChanges(changes, true);
+
+    const int inserted = qMax(0, newRows - oldRows);
+    const int removed  = qMax(0, oldRows - newRows);
+    if (inserted > 0)
+    {
+        QVector<QList<QStandardItem*>> items;
+        items.reserve(inserted);
+        for (int i = overlap; i < newRows; ++i)
+            items.append(m_model->makeRow(rows[i][CatalogModel::NameColumn],
+                                          rows[i][CatalogModel::AuthorColumn],
+                                          rows[i][CatalogModel::PagesColumn]));
+        if (modelRow + overlap == m_model->rowCount())
+            m_model->appendRows(items);
+        else
+            for (int i = 0; i < items.size(); ++i)
+                m_model->insertRow(modelRow + overlap + i, items[i]);
+    }
+    if (removed > 0)
+        m_model->removeRows(modelRow + overlap, removed);
+    m_merging = false;
+
+    m_chunks = fresh;
+
+    // Merged rows get the same checks as a loaded file; line numbers are not
+    // tracked past the first read.
+    const QVector<CatalogSchema::Issue> issues =
+        CatalogSchema::validateLines(lines, QVector<int>(lines.size(), 0), modelRow).result();
+    emit validated(modelRow, oldRows, newRows, issues);
+
+    qDebug(logInfo()) << "Merged file changes:" << changes.size() << "cells changed,"
+                      << inserted << "rows inserted," << removed << "rows removed.";
+    emit merged(changes.size(), inserted, removed, inPlace);
+}
@@ -0,0 +1,73 @@
+#ifndef CATALOGFOLLOWER_H
+#define CATALOGFOLLOWER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QVector>
+#include <QByteArray>
+
+#include "catalogmodel.h"
+#include "catalogschema.h"
+
+// Keeps the model in step with a catalog file that other programs write to.
+// The file is cut into content-defined chunks of whole lines (a line ends a
+// chunk when its hash says so), each remembered with its hash and row
+// count. After a change only the chunks between the unchanged head and tail
+// are parsed again, and the model receives cell updates, inserts and
+// removals for those rows only. Plain appends just re-read the last chunk.
+//
+// Inside the changed chunks rows are compared by the hash of their text, so
+// rows added past the old end are merged as inserts and only rows that were
+// really rewritten or dropped count as an in-place change. While local
+// inserts or removals have shifted the model against the file, new rows are
+// only accepted at the end of the file.
+class CatalogFollower : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CatalogFollower(CatalogModel* model, QObject* parent = nullptr);
+
+    void follow(const QString& path);
+    void stop();
+    bool isFollowing() const     { return !m_path.isEmpty(); }
+
+    // In-place changes are held back while the user has unsaved edits;
+    // appended rows are still merged.
+    void setLocalEdits(bool on);
+
+signals:
+    void merged(int changed, int inserted, int removed, bool inPlace);
+    // Rows [first, first + oldRows) were replaced by newRows merged rows;
+    // issues are what CatalogSchema found in them.
+    void validated(int first, int oldRows, int newRows, const QVector<CatalogSchema::Issue>& issues);
+    void conflict();
+
+private:
+    struct Chunk
+    {
+        quint64 hash;
+        qint64  offset;
+        qint64  bytes;
+        int     rows;
+        QVector<quint32> lines;     // text hash of each row
+    };
+
+    static QVector<Chunk> split(const QByteArray& data, qint64 base);
+    void reload();
+    void merge(const QVector<Chunk>& fresh, const QByteArray& data, qint64 base);
+    void onRowsMoved();
+
+    CatalogModel*           m_model;
+    QFileSystemWatcher      m_watcher;
+    QTimer                  m_debounce;
+    QString                 m_path;
+    qint64                  m_size = 0;
+    QVector<Chunk>          m_chunks;
+    bool                    m_localEdits = false;
+    bool                    m_shifted    = false;   // local inserts or removals since the last sync
+    bool                    m_merging    = false;
+};
+
+#endif // CATALOGFOLLOWER_H
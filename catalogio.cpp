@@ -0,0 +1,238 @@
+#include "catalogio.h"
+
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define CATALOGIO_SSE2
+#endif
+
+namespace {
+
+// Length of the line at p (up to n bytes, without the '\n') and whether it
+// is pure ASCII, found in one pass.
+qsizetype scanLine(const char* p, qsizetype n, bool* ascii)
+{
+    qsizetype i = 0;
+    uint high = 0;
+#ifdef CATALOGIO_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const uint eol  = uint(_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)));
+        const uint bits = uint(_mm_movemask_epi8(v));
+        if (eol)
+        {
+            const uint k = qCountTrailingZeroBits(eol);
+            high |= bits & ((1u << k) - 1);
+            *ascii = high == 0;
+            return i + k;
+        }
+        high |= bits;
+    }
+#endif
+    for (; i < n && p[i] != '\n'; ++i)
+        high |= uchar(p[i]) & 0x80;
+    *ascii = high == 0;
+    return i;
+}
+
+// Copies the leading ASCII characters of src into dst as bytes and returns
+// how many there were.
+qsizetype narrowAscii(const char16_t* src, qsizetype n, char* dst)
+{
+    qsizetype i = 0;
+#ifdef CATALOGIO_SSE2
+    const __m128i nonAscii = _mm_set1_epi16(short(0xff80));
+    const __m128i zero     = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, nonAscii), zero)) != 0xffff)
+            break;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(v, v));
+    }
+#endif
+    for (; i < n && src[i] < 0x80; ++i)
+        dst[i] = char(src[i]);
+    return i;
+}
+
+} // namespace
+
+// ------------------------------------------------------------
+
+CatalogReader::CatalogReader(QIODevice* device)
+    : m_device(device)
+    , m_decoder(QStringDecoder::Utf8, QStringConverter::Flag::Stateless)
+{
+}
+
+bool CatalogReader::fill()
+{
+    if (m_eof) return false;
+    if (m_pos > 0)
+    {
+        m_buffer.remove(0, m_pos);
+        m_pos = 0;
+    }
+    const qsizetype old = m_buffer.size();
+    m_buffer.resize(old + ChunkBytes);
+    const qint64 n = m_device->read(m_buffer.data() + old, ChunkBytes);
+    m_buffer.resize(old + qMax<qint64>(n, 0));
+    if (n <= 0)
+    {
+        m_eof = true;
+        return false;
+    }
+    m_bytes += n;
+    return true;
+}
+
+void CatalogReader::start()
+{
+    m_started = true;
+    fill();
+    const uchar* p = reinterpret_cast<const uchar*>(m_buffer.constData());
+    const qsizetype n = m_buffer.size();
+    if (n >= 3 && p[0] == 0xef && p[1] == 0xbb && p[2] == 0xbf)
+    {
+        m_pos = 3;
+        return;
+    }
+    if (n < 2 || !((p[0] == 0xff && p[1] == 0xfe) || (p[0] == 0xfe && p[1] == 0xff)))
+        return;
+
+    // UTF-16 is rare enough to be decoded whole.
+    const bool littleEndian = p[0] == 0xff;
+    QByteArray data = m_buffer.mid(2);
+    const QByteArray rest = m_device->readAll();
+    m_bytes += rest.size();
+    data += rest;
+    m_buffer.clear();
+    m_eof = true;
+
+    QStringDecoder decoder(littleEndian ? QStringDecoder::Utf16LE : QStringDecoder::Utf16BE);
+    const QString text = decoder(data);
+    if (decoder.hasError())
+        ++m_invalid;
+    m_utf16Lines = text.split(QLatin1Char('\n'));
+    if (!m_utf16Lines.isEmpty() && m_utf16Lines.last().isEmpty())
+        m_utf16Lines.removeLast();
+    m_utf16Next = 0;
+}
+
+QString CatalogReader::decode(const char* data, qsizetype size)
+{
+    const QString text = m_decoder(QByteArrayView(data, size));
+    if (m_decoder.hasError())
+    {
+        ++m_invalid;
+        m_decoder.resetState();
+    }
+    return text;
+}
+
+bool CatalogReader::readLine(QString* line)
+{
+    if (!m_started)
+        start();
+
+    if (m_utf16Next >= 0)
+    {
+        if (m_utf16Next >= m_utf16Lines.size())
+            return false;
+        *line = m_utf16Lines.at(m_utf16Next++);
+        if (line->endsWith(QLatin1Char('\r')))
+            line->chop(1);
+        return true;
+    }
+
+    // A line that runs past the buffer is scanned again once more is read.
+    qsizetype length = 0;
+    bool ascii = true;
+    for (;;)
+    {
+        const qsizetype available = m_buffer.size() - m_pos;
+        length = scanLine(m_buffer.constData() + m_pos, available, &ascii);
+        if (length < available || !fill())
+            break;
+    }
+
+    const qsizetype available = m_buffer.size() - m_pos;
+    if (available == 0)
+        return false;
+    const char* p = m_buffer.constData() + m_pos;
+    m_pos += length < available ? length + 1 : length;
+
+    qsizetype size = length;
+    if (size > 0 && p[size - 1] == '\r')
+        --size;
+    *line = ascii ? QString::fromLatin1(p, size) : decode(p, size);
+    return true;
+}
+
+// ------------------------------------------------------------
+
+CatalogWriter::CatalogWriter(QIODevice* device)
+    : m_device(device)
+    , m_buffer(BufferBytes, Qt::Uninitialized)
+    , m_encoder(QStringEncoder::Utf8, QStringConverter::Flag::Stateless)
+{
+    m_data = m_buffer.data();
+}
+
+CatalogWriter::~CatalogWriter()
+{
+    flush();
+}
+
+void CatalogWriter::reserve(qsizetype bytes)
+{
+    if (m_used + bytes <= m_buffer.size())
+        return;
+    flush();
+    if (bytes > m_buffer.size())
+    {
+        m_buffer.resize(bytes);
+        m_data = m_buffer.data();
+    }
+}
+
+void CatalogWriter::put(QStringView text)
+{
+    char* out = m_data + m_used;
+    const qsizetype ascii = narrowAscii(text.utf16(), text.size(), out);
+    if (ascii == text.size())
+    {
+        m_used += ascii;
+        return;
+    }
+    char* end = m_encoder.appendToBuffer(out + ascii, text.mid(ascii));
+    m_used = end - m_data;
+}
+
+// UTF-8 takes at most three bytes per UTF-16 unit, so one check per row
+// covers all three cells and the separators.
+void CatalogWriter::writeRow(const QString& name, const QString& author, const QString& pages)
+{
+    reserve(3 * (name.size() + author.size() + pages.size()) + 3);
+    put(name);
+    m_data[m_used++] = '\t';
+    put(author);
+    m_data[m_used++] = '\t';
+    put(pages);
+    m_data[m_used++] = '\n';
+}
+
+bool CatalogWriter::flush()
+{
+    if (m_used > 0)
+    {
+        if (m_device->write(m_data, m_used) != m_used)
+            m_failed = true;
+        m_used = 0;
+    }
+    return !m_failed;
+}
@@ -0,0 +1,75 @@
+#ifndef CATALOGIO_H
+#define CATALOGIO_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QStringConverter>
+
+// Catalog text I/O on raw bytes in place of QTextStream. The reader finds
+// line ends and checks for ASCII 16 bytes at a time (SSE2 where the target
+// has it); ASCII lines are widened straight into a QString and only the
+// others go through the UTF-8 decoder, which also counts lines that were
+// not valid UTF-8. A UTF-8 byte order mark is skipped and UTF-16 files are
+// still read, through a slower path.
+class CatalogReader
+{
+public:
+    explicit CatalogReader(QIODevice* device);
+
+    // Returns false at the end of the input; the line excludes "\n" or "\r\n".
+    bool readLine(QString* line);
+
+    int    invalidLines() const    { return m_invalid; }
+    qint64 bytesRead() const       { return m_bytes; }
+
+private:
+    static constexpr qint64 ChunkBytes = 1 << 20;
+
+    bool fill();
+    void start();
+    QString decode(const char* data, qsizetype size);
+
+    QIODevice*      m_device;
+    QByteArray      m_buffer;
+    qsizetype       m_pos      = 0;
+    qint64          m_bytes    = 0;
+    bool            m_started  = false;
+    bool            m_eof      = false;
+    int             m_invalid  = 0;
+    QStringDecoder  m_decoder;
+
+    QStringList     m_utf16Lines;
+    int             m_utf16Next = -1;
+};
+
+// Writes rows as tab-separated UTF-8 lines through a 1 MB buffer. ASCII
+// text is narrowed into the buffer eight characters at a time; anything
+// else from its first non-ASCII character on is encoded in place, so no
+// temporary QByteArray is made per cell.
+class CatalogWriter
+{
+public:
+    explicit CatalogWriter(QIODevice* device);
+    ~CatalogWriter();
+
+    void writeRow(const QString& name, const QString& author, const QString& pages);
+    bool flush();
+    bool failed() const     { return m_failed; }
+
+private:
+    static constexpr qsizetype BufferBytes = 1 << 20;
+
+    void reserve(qsizetype bytes);
+    void put(QStringView text);
+
+    QIODevice*      m_device;
+    QByteArray      m_buffer;
+    char*           m_data = nullptr;
+    qsizetype       m_used = 0;
+    bool            m_failed = false;
+    QStringEncoder  m_encoder;
+};
+
+#endif // CATALOGIO_H
@@ -0,0 +1,206 @@
+#include "catalogmodel.h"
+
+#include <QSignalBlocker>
+
+CatalogModel::CatalogModel(QObject* parent)
+    : QStandardItemModel(0, ColumnCount, parent)
+{
+    for (int c = 0; c < ColumnCount; ++c)
+        setHeaderData(c, Qt::Horizontal, columnName(c));
+
+    connect(this, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &CatalogModel::releaseRows);
+
+    // Connected first, so other observers already find the store current.
+    connect(this, &QAbstractItemModel::rowsInserted, this, &CatalogModel::storeInserted);
+    connect(this, &QAbstractItemModel::rowsRemoved,  this, &CatalogModel::storeRemoved);
+    connect(this, &QAbstractItemModel::modelReset,   this, &CatalogModel::storeReset);
+    connect(this, &CatalogModel::rowChanged,         this, &CatalogModel::storeChanged);
+}
+
+bool CatalogModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (index.parent().isValid() || (role != Qt::EditRole && role != Qt::DisplayRole))
+        return QStandardItemModel::setData(index, value, role);
+
+    emit rowAboutToChange(index.row(), index.column());
+    const bool ok = index.column() == AuthorColumn
+                        ? setAuthor(index, value)
+                        : QStandardItemModel::setData(index, value, role);
+    emit rowChanged(index.row(), index.column());
+    return ok;
+}
+
+bool CatalogModel::setAuthor(const QModelIndex& index, const QVariant& value)
+{
+    QStandardItem* item = itemFromIndex(index);
+    if (!item) return false;
+
+    const QVariant oldId = item->data(AuthorIdRole);
+    const int newId = m_authors.intern(value.toString());
+
+    // Both roles go in at once so the item emits a single itemChanged.
+    QMap<int, QVariant> roles;
+    roles.insert(Qt::DisplayRole, m_authors.name(newId));
+    roles.insert(AuthorIdRole,    newId);
+    if (!QStandardItemModel::setItemData(index, roles))
+        return false;
+
+    m_authors.retain(newId);
+    if (oldId.isValid())
+        m_authors.release(oldId.toInt());
+    return true;
+}
+
+QList<QStandardItem*> CatalogModel::makeRow(const QString& name, const QString& author, const QString& pages)
+{
+    return makeRow(name, m_authors.intern(author), pages);
+}
+
+// For callers that interned the author already, e.g. once per distinct name.
+QList<QStandardItem*> CatalogModel::makeRow(const QString& name, int id, const QString& pages)
+{
+    m_authors.retain(id);
+
+    QStandardItem* authorItem = new QStandardItem(m_authors.name(id));
+    authorItem->setData(id, AuthorIdRole);
+
+    QList<QStandardItem*> items;
+    items << new QStandardItem(name)
+          << authorItem
+          << new QStandardItem(pages);
+    return items;
+}
+
+// Appends a block of rows as one insertion, so views and observers handle a
+// single rowsInserted instead of one per row. The per-row inserts underneath
+// are silenced; they only add rows past the end, so no persistent index moves.
+void CatalogModel::appendRows(const QVector<QList<QStandardItem*>>& rows)
+{
+    if (rows.isEmpty()) return;
+
+    const int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + rows.size() - 1);
+    blockSignals(true);
+    for (const QList<QStandardItem*>& row : rows)
+        appendRow(row);
+    blockSignals(false);
+    endInsertRows();
+}
+
+void CatalogModel::clearRows()
+{
+    removeRows(0, rowCount());
+    m_authors.clear();
+}
+
+// Bulk loads are reported as a single model reset instead of one insert per
+// row; views and observers rebuild once in endLoad().
+void CatalogModel::beginLoad()
+{
+    beginResetModel();
+    blockSignals(true);
+    clearRows();
+}
+
+void CatalogModel::endLoad()
+{
+    blockSignals(false);
+    endResetModel();
+}
+
+// Writes many cells as one update: observers still see every row change, but
+// itemChanged is suppressed and views get a single dataChanged for the span.
+void CatalogModel::applyChanges(const QVector<CellChange>& changes, bool forward)
+{
+    if (changes.isEmpty()) return;
+
+    int top = rowCount(), bottom = -1, left = ColumnCount, right = -1;
+    for (const CellChange& ch : changes)
+    {
+        const QModelIndex idx = index(ch.row, ch.column);
+        const QString& value = forward ? ch.after : ch.before;
+        emit rowAboutToChange(ch.row, ch.column);
+        {
+            const QSignalBlocker blocker(this);
+            if (ch.column == AuthorColumn)
+                setAuthor(idx, value);
+            else
+                QStandardItemModel::setData(idx, value);
+        }
+        emit rowChanged(ch.row, ch.column);
+
+        top    = qMin(top, ch.row);
+        bottom = qMax(bottom, ch.row);
+        left   = qMin(left, ch.column);
+        right  = qMax(right, ch.column);
+    }
+    emit dataChanged(index(top, left), index(bottom, right));
+}
+
+QString CatalogModel::columnName(int column)
+{
+    switch (column)
+    {
+        case NameColumn:   return tr("Name");
+        case AuthorColumn: return tr("Author");
+        case PagesColumn:  return tr("Pages");
+        default:           return QString();
+    }
+}
+
+int CatalogModel::authorId(int row) const
+{
+    const QStandardItem* it = item(row, AuthorColumn);
+    if (!it) return -1;
+    const QVariant id = it->data(AuthorIdRole);
+    return id.isValid() ? id.toInt() : -1;
+}
+
+void CatalogModel::releaseRows(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    for (int r = first; r <= last; ++r)
+        m_authors.release(authorId(r));
+}
+
+CatalogStore::Row CatalogModel::storeRow(int row) const
+{
+    CatalogStore::Row r;
+    if (const QStandardItem* it = item(row, NameColumn))   r.name   = it->text();
+    if (const QStandardItem* it = item(row, AuthorColumn)) r.author = it->text();
+    if (const QStandardItem* it = item(row, PagesColumn))  r.pages  = it->text();
+    r.authorId = authorId(row);
+    return r;
+}
+
+void CatalogModel::storeInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    QVector<CatalogStore::Row> rows;
+    rows.reserve(last - first + 1);
+    for (int r = first; r <= last; ++r)
+        rows.append(storeRow(r));
+    m_store.insert(first, rows);
+}
+
+void CatalogModel::storeRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    m_store.remove(first, last - first + 1);
+}
+
+void CatalogModel::storeChanged(int row, int column)
+{
+    const QStandardItem* it = item(row, column);
+    m_store.setText(row, column, it ? it->text() : QString(), column == AuthorColumn ? authorId(row) : -1);
+}
+
+void CatalogModel::storeReset()
+{
+    QVector<CatalogStore::Row> rows;
+    rows.reserve(rowCount());
+    for (int r = 0; r < rowCount(); ++r)
+        rows.append(storeRow(r));
+    m_store.reset(rows);
+}
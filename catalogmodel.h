@@ -0,0 +1,70 @@
+#ifndef CATALOGMODEL_H
+#define CATALOGMODEL_H
+
+#include <QStandardItemModel>
+#include <QStandardItem>
+#include <QList>
+#include <QVector>
+
+#include "authorpool.h"
+#include "catalogstore.h"
+
+class CatalogModel : public QStandardItemModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn = 0, AuthorColumn = 1, PagesColumn = 2, ColumnCount = 3 };
+    enum Role   { AuthorIdRole = Qt::UserRole + 1 };
+
+    struct CellChange
+    {
+        int     row;
+        int     column;
+        QString before;
+        QString after;
+    };
+
+    explicit CatalogModel(QObject* parent = nullptr);
+
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+
+    QList<QStandardItem*> makeRow(const QString& name, const QString& author, const QString& pages);
+    QList<QStandardItem*> makeRow(const QString& name, int authorId, const QString& pages);
+    void appendRows(const QVector<QList<QStandardItem*>>& rows);
+    void clearRows();
+    void beginLoad();
+    void endLoad();
+    void applyChanges(const QVector<CellChange>& changes, bool forward);
+
+    static QString columnName(int column);
+
+    int authorId(int row) const;
+    AuthorPool&       authors()         { return m_authors; }
+    const AuthorPool& authors() const   { return m_authors; }
+
+    // A copy of the rows that stays valid, unchanged and readable from any
+    // thread while the model goes on being edited.
+    CatalogStore::Snapshot snapshot() const { return m_store.snapshot(); }
+    quint64 version() const                 { return m_store.version(); }
+
+signals:
+    // Emitted around every edit of a top-level cell so observers can retract
+    // the row's old contribution and add the new one without rescanning.
+    void rowAboutToChange(int row, int column);
+    void rowChanged(int row, int column);
+
+private:
+    bool setAuthor(const QModelIndex& index, const QVariant& value);
+    void releaseRows(const QModelIndex& parent, int first, int last);
+    CatalogStore::Row storeRow(int row) const;
+    void storeInserted(const QModelIndex& parent, int first, int last);
+    void storeRemoved(const QModelIndex& parent, int first, int last);
+    void storeChanged(int row, int column);
+    void storeReset();
+
+    AuthorPool   m_authors;
+    CatalogStore m_store;
+};
+
+#endif // CATALOGMODEL_H
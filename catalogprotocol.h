@@ -0,0 +1,73 @@
+#ifndef CATALOGPROTOCOL_H
+#define CATALOGPROTOCOL_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <QtEndian>
+
+// Wire format shared by CatalogServer and CatalogClient.
+//
+// Every message is a frame: a big-endian quint32 payload size followed by
+// a QDataStream (Qt 6.0) payload. Requests start with quint32 id and
+// quint8 op, replies with the request's id and a quint8 status; an Error
+// reply carries a QString. Requests may be pipelined: the server answers
+// each connection strictly in order.
+//
+//   Count                               -> qint32 rows
+//   Query   QString text, qint32 limit  -> qint32 total, qint32 n, n x (qint32 row, Row)
+//   Lookup  qint32 n, n x qint32 row    -> qint32 n, n x (qint32 row, Row); row is -1 if missing
+//   Insert  qint32 n, n x Row           -> qint32 firstRow, qint32 n
+//
+// Query takes the search bar's syntax. Inserts are appended at the end;
+// the server applies everything that arrived together as one block. One
+// Insert carries at most 65536 rows, and is refused whole with an Error
+// naming the first row that breaks the catalog's rules (CatalogSchema).
+namespace CatalogProtocol
+{
+    inline constexpr const char* DefaultServerName = "laba2-catalog";
+    inline constexpr quint32     MaxFrameBytes     = 64u << 20;
+    inline constexpr int         MinRowBytes       = 12;    // three string lengths
+
+    enum Op : quint8     { Count = 1, Query = 2, Lookup = 3, Insert = 4 };
+    enum Status : quint8 { Ok = 0, Error = 1 };
+
+    struct Row
+    {
+        QString name;
+        QString author;
+        QString pages;
+    };
+
+    inline QDataStream& operator<<(QDataStream& out, const Row& r) { return out << r.name << r.author << r.pages; }
+    inline QDataStream& operator>>(QDataStream& in, Row& r)        { return in >> r.name >> r.author >> r.pages; }
+
+    inline void appendFrame(QByteArray& out, const QByteArray& payload)
+    {
+        const quint32 size = qToBigEndian(quint32(payload.size()));
+        out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.append(payload);
+    }
+
+    // Takes the next complete frame from buffer at offset; returns false if
+    // it has not fully arrived. A frame over MaxFrameBytes sets tooLarge.
+    inline bool takeFrame(const QByteArray& buffer, int& offset, QByteArray* payload, bool* tooLarge)
+    {
+        *tooLarge = false;
+        if (buffer.size() - offset < 4)
+            return false;
+        const quint32 size = qFromBigEndian<quint32>(buffer.constData() + offset);
+        if (size > MaxFrameBytes)
+        {
+            *tooLarge = true;
+            return false;
+        }
+        if (quint32(buffer.size() - offset - 4) < size)
+            return false;
+        *payload = buffer.mid(offset + 4, int(size));
+        offset += 4 + int(size);
+        return true;
+    }
+}
+
+#endif // CATALOGPROTOCOL_H
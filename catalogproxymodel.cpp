@@ -0,0 +1,227 @@
+#include "catalogproxymodel.h"
+
+CatalogProxyModel::CatalogProxyModel(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+    setSortCaseSensitivity(Qt::CaseInsensitive);
+    setFilterCaseSensitivity(Qt::CaseInsensitive);
+    setFilterKeyColumn(-1);
+}
+
+void CatalogProxyModel::setCatalog(CatalogModel* model)
+{
+    m_catalog = model;
+
+    // Connected ahead of the proxy's own handler, so the tables are rebuilt
+    // before the rows are filtered again.
+    connect(model, &QAbstractItemModel::modelReset, this, &CatalogProxyModel::onModelReset);
+    setSourceModel(model);
+
+    // "About to" signals arrive before the proxy re-filters the affected rows;
+    // removals only shift the cache, which the proxy never reads meanwhile.
+    connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this, &CatalogProxyModel::onRowsAboutToBeInserted);
+    connect(model, &QAbstractItemModel::rowsRemoved,           this, &CatalogProxyModel::onRowsRemoved);
+    connect(model, &QAbstractItemModel::modelAboutToBeReset,   this, &CatalogProxyModel::onModelAboutToBeReset);
+    connect(model, &CatalogModel::rowAboutToChange,            this, &CatalogProxyModel::onRowAboutToChange);
+}
+
+// The index must see the model's signals first (be created before
+// setCatalog()), so inserted rows are already listed when they are filtered.
+void CatalogProxyModel::setAuthorIndex(AuthorIndex* index)
+{
+    m_authorIndex = index;
+    connect(m_catalog, &CatalogModel::rowChanged, this, &CatalogProxyModel::onRowChanged);
+}
+
+void CatalogProxyModel::setSearchText(const QString& text)
+{
+    m_search = text;
+    m_fuzzyCache.clear();
+    m_fuzzyStale = false;
+    compileSearch();
+    if (m_fuzzy)
+    {
+        compileFuzzy();
+        return;
+    }
+
+    invalidateFilter();
+}
+
+// Both the compiled query and the author table are indexed by pool id.
+void CatalogProxyModel::compileSearch()
+{
+    m_authorMatch.clear();
+    m_query = CatalogQuery();
+    m_queryError.clear();
+    if (!m_catalog || m_search.isEmpty() || m_fuzzy)
+        return;
+    if (CatalogQuery::looksStructured(m_search))
+        m_query = CatalogQuery::compile(m_search, m_catalog->authors(), &m_queryError);
+    if (!m_query.isValid())
+    {
+        const AuthorPool& pool = m_catalog->authors();
+        m_authorMatch.resize(pool.size());
+        for (int id = 0; id < pool.size(); ++id)
+            m_authorMatch[id] = pool.name(id).contains(m_search, Qt::CaseInsensitive);
+    }
+}
+
+// Restricts the table to one author's books; -1 lifts the restriction.
+void CatalogProxyModel::setAuthorScope(int authorId)
+{
+    if (m_authorScope == authorId) return;
+    m_authorScope = authorId;
+    invalidateFilter();
+}
+
+bool CatalogProxyModel::inAuthorScope(int sourceRow) const
+{
+    if (!m_authorIndex)
+        return m_catalog->authorId(sourceRow) == m_authorScope;
+    return m_authorIndex->rows(m_authorScope).contains(m_catalog->item(sourceRow, CatalogModel::AuthorColumn));
+}
+
+// An edit that moves a row into the scope is filtered before the index
+// lists the row under its new author, so the filter is run again once, after
+// the edit (or a batch of them) is complete.
+void CatalogProxyModel::onRowChanged(int row, int column)
+{
+    if (column != CatalogModel::AuthorColumn || m_authorScope < 0 || m_rescopePending)
+        return;
+    if (m_catalog->authorId(row) != m_authorScope)
+        return;
+    m_rescopePending = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_rescopePending = false;
+        if (m_authorScope >= 0)
+            invalidateFilter();
+    }, Qt::QueuedConnection);
+}
+
+// In fuzzy mode rows within maxDistance edits of the search text are kept and
+// ranked best match first, ahead of the sort column.
+void CatalogProxyModel::setFuzzy(bool on, int maxDistance)
+{
+    const bool wasFuzzy = m_fuzzy;
+    m_fuzzy = on;
+    m_maxDistance = maxDistance;
+    setSearchText(m_search);
+    if (wasFuzzy && !on)
+        invalidate();
+}
+
+void CatalogProxyModel::compileFuzzy()
+{
+    m_matcher = FuzzyMatcher(m_search);
+    m_fuzzyCache.clear();
+    if (m_catalog && !m_matcher.isEmpty())
+        m_fuzzyCache = m_matcher.scanRows(m_catalog);
+
+    invalidate();
+    if (m_fuzzy && !m_matcher.isEmpty() && sortColumn() < 0)
+        sort(CatalogModel::NameColumn);
+}
+
+int CatalogProxyModel::fuzzyDistance(int sourceRow) const
+{
+    if (m_fuzzyStale)
+    {
+        m_fuzzyStale = false;
+        m_fuzzyCache = m_matcher.scanRows(m_catalog);
+    }
+
+    static const QVector<quint8> noAuthors;
+    if (sourceRow >= m_fuzzyCache.size())
+        return m_matcher.rowDistance(m_catalog, sourceRow, noAuthors);
+    quint8& d = m_fuzzyCache[sourceRow];
+    if (d == Unscored)
+        d = quint8(m_matcher.rowDistance(m_catalog, sourceRow, noAuthors));
+    return d;
+}
+
+void CatalogProxyModel::onRowsAboutToBeInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid() || !fuzzyActive() || m_fuzzyStale)
+        return;
+    if (first > m_fuzzyCache.size())
+        m_fuzzyStale = true;
+    else
+        m_fuzzyCache.insert(first, last - first + 1, Unscored);
+}
+
+void CatalogProxyModel::onRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid() || !fuzzyActive() || m_fuzzyStale)
+        return;
+    if (last >= m_fuzzyCache.size())
+        m_fuzzyStale = true;
+    else
+        m_fuzzyCache.remove(first, last - first + 1);
+}
+
+void CatalogProxyModel::onRowAboutToChange(int row, int column)
+{
+    if (column == CatalogModel::PagesColumn || !fuzzyActive() || m_fuzzyStale)
+        return;
+    if (row < m_fuzzyCache.size())
+        m_fuzzyCache[row] = Unscored;
+}
+
+void CatalogProxyModel::onModelAboutToBeReset()
+{
+    m_fuzzyCache.clear();
+    m_fuzzyStale = fuzzyActive();
+}
+
+// A reload renumbers the author pool, so the per-id tables are rebuilt.
+void CatalogProxyModel::onModelReset()
+{
+    compileSearch();
+}
+
+bool CatalogProxyModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    if (m_fuzzy && !m_matcher.isEmpty())
+    {
+        const int dl = fuzzyDistance(left.row());
+        const int dr = fuzzyDistance(right.row());
+        if (dl != dr)
+            return (sortOrder() == Qt::AscendingOrder) ? dl < dr : dl > dr;
+    }
+    return QSortFilterProxyModel::lessThan(left, right);
+}
+
+bool CatalogProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    if (!m_catalog)
+        return true;
+    if (m_authorScope >= 0 && !inAuthorScope(sourceRow))
+        return false;
+    if (m_search.isEmpty())
+        return true;
+    if (m_fuzzy)
+        return fuzzyDistance(sourceRow) <= m_maxDistance;
+    if (m_query.isValid())
+        return m_query.matches(m_catalog, sourceRow);
+
+    const auto contains = [&](int column) {
+        return m_catalog->index(sourceRow, column, sourceParent).data()
+                   .toString().contains(m_search, Qt::CaseInsensitive);
+    };
+
+    return contains(CatalogModel::NameColumn)
+        || authorMatches(sourceRow)
+        || contains(CatalogModel::PagesColumn);
+}
+
+bool CatalogProxyModel::authorMatches(int sourceRow) const
+{
+    const int id = m_catalog->authorId(sourceRow);
+    if (id >= 0 && id < m_authorMatch.size())
+        return m_authorMatch[id];
+
+    // Authors interned after the search was compiled fall back to text.
+    return m_catalog->index(sourceRow, CatalogModel::AuthorColumn).data()
+               .toString().contains(m_search, Qt::CaseInsensitive);
+}
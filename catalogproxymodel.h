@@ -0,0 +1,71 @@
+#ifndef CATALOGPROXYMODEL_H
+#define CATALOGPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QVector>
+
+#include "catalogmodel.h"
+#include "catalogquery.h"
+#include "fuzzymatcher.h"
+#include "authorindex.h"
+
+// Case-insensitive substring filter over all columns. The Author column is
+// matched once per distinct pooled author; rows are then tested by id.
+// Search text using the CatalogQuery syntax is compiled and used instead.
+// An author scope is answered from AuthorIndex's rows for that author.
+class CatalogProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit CatalogProxyModel(QObject* parent = nullptr);
+
+    void setCatalog(CatalogModel* model);
+    void setAuthorIndex(AuthorIndex* index);
+    QString queryError() const { return m_queryError; }
+    bool isFuzzy() const       { return m_fuzzy; }
+
+public slots:
+    void setSearchText(const QString& text);
+    void setAuthorScope(int authorId);
+    void setFuzzy(bool on, int maxDistance);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+private:
+    void compileSearch();
+    bool authorMatches(int sourceRow) const;
+    bool inAuthorScope(int sourceRow) const;
+    void onRowChanged(int row, int column);
+    void compileFuzzy();
+    int  fuzzyDistance(int sourceRow) const;
+    bool fuzzyActive() const    { return m_fuzzy && !m_matcher.isEmpty(); }
+    void onRowsAboutToBeInserted(const QModelIndex& parent, int first, int last);
+    void onRowsRemoved(const QModelIndex& parent, int first, int last);
+    void onRowAboutToChange(int row, int column);
+    void onModelAboutToBeReset();
+    void onModelReset();
+
+    CatalogModel*   m_catalog = nullptr;
+    QString         m_search;
+    AuthorIndex*    m_authorIndex = nullptr;
+    int             m_authorScope = -1;
+    bool            m_rescopePending = false;
+    QVector<bool>   m_authorMatch;
+    CatalogQuery    m_query;
+    QString         m_queryError;
+
+    bool            m_fuzzy = false;
+    int             m_maxDistance = 1;
+    FuzzyMatcher    m_matcher;
+
+    // Per source row; edited and inserted rows are marked Unscored and scored
+    // when next asked for, a reset has the whole table rescanned.
+    static constexpr quint8 Unscored = FuzzyMatcher::NoMatch - 1;
+    mutable QVector<quint8> m_fuzzyCache;
+    mutable bool            m_fuzzyStale = false;
+};
+
+#endif // CATALOGPROXYMODEL_H
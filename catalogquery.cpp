@@ -0,0 +1,399 @@
+#include "catalogquery.h"
+
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+
+enum class Op { Contains, Equals, NotEquals, Less, LessEq, Greater, GreaterEq };
+
+QString cellText(const CatalogModel* model, int row, int column)
+{
+    const QStandardItem* it = model->item(row, column);
+    return it ? it->text() : QString();
+}
+
+bool textMatches(const QString& value, Op op, const QString& needle)
+{
+    switch (op)
+    {
+        case Op::Equals:    return value.compare(needle, Qt::CaseInsensitive) == 0;
+        case Op::NotEquals: return value.compare(needle, Qt::CaseInsensitive) != 0;
+        default:            return value.contains(needle, Qt::CaseInsensitive);
+    }
+}
+
+} // namespace
+
+struct CatalogQuery::Node
+{
+    virtual ~Node() = default;
+    virtual bool eval(const CatalogModel* model, int row) const = 0;
+    virtual bool eval(const CatalogStore::Row& row) const = 0;
+    virtual int  cost() const = 0;
+};
+
+namespace {
+
+using NodePtr = std::unique_ptr<CatalogQuery::Node>;
+
+struct TextNode : CatalogQuery::Node
+{
+    TextNode(int c, Op o, const QString& n) : column(c), op(o), needle(n) {}
+    bool eval(const CatalogModel* model, int row) const override
+    {
+        return textMatches(cellText(model, row, column), op, needle);
+    }
+    bool eval(const CatalogStore::Row& row) const override
+    {
+        return textMatches(row.text(column), op, needle);
+    }
+    int cost() const override { return 4; }
+
+    int     column;
+    Op      op;
+    QString needle;
+};
+
+// Matched once per distinct author when compiled; rows only look up their id.
+struct AuthorNode : CatalogQuery::Node
+{
+    AuthorNode(Op o, const QString& n, const AuthorPool& pool) : op(o), needle(n)
+    {
+        match.resize(pool.size());
+        for (int id = 0; id < pool.size(); ++id)
+            match[id] = textMatches(pool.name(id), op, needle);
+    }
+    bool eval(const CatalogModel* model, int row) const override
+    {
+        const int id = model->authorId(row);
+        if (id >= 0 && id < match.size())
+            return match[id];
+        return textMatches(cellText(model, row, CatalogModel::AuthorColumn), op, needle);
+    }
+    bool eval(const CatalogStore::Row& row) const override
+    {
+        if (row.authorId >= 0 && row.authorId < match.size())
+            return match[row.authorId];
+        return textMatches(row.author, op, needle);
+    }
+    int cost() const override { return 1; }
+
+    Op              op;
+    QString         needle;
+    QVector<bool>   match;
+};
+
+struct PagesNode : CatalogQuery::Node
+{
+    PagesNode(Op o, int v) : op(o), value(v) {}
+    bool eval(const CatalogModel* model, int row) const override
+    {
+        return test(cellText(model, row, CatalogModel::PagesColumn));
+    }
+    bool eval(const CatalogStore::Row& row) const override
+    {
+        return test(row.pages);
+    }
+    bool test(const QString& text) const
+    {
+        bool ok = false;
+        const int pages = text.toInt(&ok);
+        if (!ok) return op == Op::NotEquals;
+        switch (op)
+        {
+            case Op::Less:      return pages <  value;
+            case Op::LessEq:    return pages <= value;
+            case Op::Greater:   return pages >  value;
+            case Op::GreaterEq: return pages >= value;
+            case Op::NotEquals: return pages != value;
+            default:            return pages == value;
+        }
+    }
+    int cost() const override { return 2; }
+
+    Op  op;
+    int value;
+};
+
+struct NotNode : CatalogQuery::Node
+{
+    explicit NotNode(NodePtr c) : child(std::move(c)) {}
+    bool eval(const CatalogModel* model, int row) const override { return !child->eval(model, row); }
+    bool eval(const CatalogStore::Row& row) const override        { return !child->eval(row); }
+    int cost() const override { return child->cost(); }
+
+    NodePtr child;
+};
+
+// Children are kept cheapest first, so id and integer tests short-circuit
+// before any string is compared.
+struct ListNode : CatalogQuery::Node
+{
+    explicit ListNode(bool all) : isAnd(all) {}
+    bool eval(const CatalogModel* model, int row) const override
+    {
+        for (const NodePtr& c : children)
+            if (c->eval(model, row) != isAnd)
+                return !isAnd;
+        return isAnd;
+    }
+    bool eval(const CatalogStore::Row& row) const override
+    {
+        for (const NodePtr& c : children)
+            if (c->eval(row) != isAnd)
+                return !isAnd;
+        return isAnd;
+    }
+    int cost() const override
+    {
+        int total = 0;
+        for (const NodePtr& c : children) total += c->cost();
+        return total;
+    }
+    void finish()
+    {
+        std::stable_sort(children.begin(), children.end(),
+                         [](const NodePtr& a, const NodePtr& b) { return a->cost() < b->cost(); });
+    }
+
+    bool                 isAnd;
+    std::vector<NodePtr> children;
+};
+
+struct Token
+{
+    enum Kind { Word, Quoted, Operator, Open, Close, End } kind = End;
+    QString text;
+};
+
+class Parser
+{
+public:
+    Parser(const QString& text, const AuthorPool& pool) : m_pool(pool) { tokenize(text); }
+
+    NodePtr parse(QString* error)
+    {
+        NodePtr root = parseOr();
+        if (m_error.isEmpty() && peek().kind != Token::End)
+            m_error = QObject::tr("Unexpected '%1'").arg(peek().text);
+        if (!m_error.isEmpty())
+        {
+            if (error) *error = m_error;
+            return nullptr;
+        }
+        return root;
+    }
+
+private:
+    static bool isOperatorChar(QChar ch)
+    {
+        return ch == ':' || ch == '=' || ch == '~' || ch == '<' || ch == '>' || ch == '!';
+    }
+
+    void tokenize(const QString& s)
+    {
+        int i = 0;
+        while (i < s.size())
+        {
+            const QChar ch = s[i];
+            Token t;
+            if (ch.isSpace()) { ++i; continue; }
+            if (ch == '(' || ch == ')')
+            {
+                t.kind = ch == '(' ? Token::Open : Token::Close;
+                t.text = ch;
+                ++i;
+            }
+            else if (ch == '"')
+            {
+                const int close = s.indexOf('"', i + 1);
+                const int end = close < 0 ? s.size() : close;
+                t.kind = Token::Quoted;
+                t.text = s.mid(i + 1, end - i - 1);
+                i = end + 1;
+            }
+            else if (isOperatorChar(ch))
+            {
+                int j = i + 1;
+                if (j < s.size() && s[j] == '=' && ch != ':' && ch != '~') ++j;
+                t.kind = Token::Operator;
+                t.text = s.mid(i, j - i);
+                i = j;
+            }
+            else
+            {
+                int j = i;
+                while (j < s.size() && !s[j].isSpace() && s[j] != '(' && s[j] != ')'
+                       && s[j] != '"' && !isOperatorChar(s[j]))
+                    ++j;
+                t.kind = Token::Word;
+                t.text = s.mid(i, j - i);
+                i = j;
+            }
+            m_tokens.append(t);
+        }
+    }
+
+    const Token& peek(int ahead = 0) const
+    {
+        static const Token end;
+        return m_pos + ahead < m_tokens.size() ? m_tokens[m_pos + ahead] : end;
+    }
+    Token take()                     { Token t = peek(); if (m_pos < m_tokens.size()) ++m_pos; return t; }
+    bool  isKeyword(const char* kw) const { return peek().kind == Token::Word && peek().text == QLatin1String(kw); }
+
+    NodePtr parseOr()
+    {
+        std::unique_ptr<ListNode> list(new ListNode(false));
+        list->children.push_back(parseAnd());
+        while (m_error.isEmpty() && isKeyword("OR"))
+        {
+            take();
+            list->children.push_back(parseAnd());
+        }
+        return collapse(std::move(list));
+    }
+
+    NodePtr parseAnd()
+    {
+        std::unique_ptr<ListNode> list(new ListNode(true));
+        list->children.push_back(parseUnary());
+        while (m_error.isEmpty())
+        {
+            const Token& t = peek();
+            if (t.kind == Token::End || t.kind == Token::Close || isKeyword("OR"))
+                break;
+            if (isKeyword("AND"))
+                take();
+            list->children.push_back(parseUnary());
+        }
+        return collapse(std::move(list));
+    }
+
+    NodePtr parseUnary()
+    {
+        if (isKeyword("NOT"))
+        {
+            take();
+            return NodePtr(new NotNode(parseUnary()));
+        }
+        if (peek().kind == Token::Open)
+        {
+            take();
+            NodePtr inner = parseOr();
+            if (peek().kind != Token::Close)
+                fail(QObject::tr("Missing ')'"));
+            else
+                take();
+            return inner;
+        }
+        return parseTerm();
+    }
+
+    NodePtr parseTerm()
+    {
+        const Token t = take();
+        if (t.kind != Token::Word && t.kind != Token::Quoted)
+            return fail(QObject::tr("Expected a search term"));
+
+        if (t.kind == Token::Quoted || peek().kind != Token::Operator)
+            return anyColumn(t.text);
+
+        const QString field = t.text.toLower();
+        const QString opText = take().text;
+        const Token value = take();
+        if (value.kind != Token::Word && value.kind != Token::Quoted)
+            return fail(QObject::tr("Missing value after '%1%2'").arg(t.text, opText));
+
+        Op op;
+        if      (opText == ":" || opText == "~") op = Op::Contains;
+        else if (opText == "=")  op = Op::Equals;
+        else if (opText == "!=") op = Op::NotEquals;
+        else if (opText == "<")  op = Op::Less;
+        else if (opText == "<=") op = Op::LessEq;
+        else if (opText == ">")  op = Op::Greater;
+        else if (opText == ">=") op = Op::GreaterEq;
+        else return fail(QObject::tr("Unknown operator '%1'").arg(opText));
+
+        const bool ordering = op == Op::Less || op == Op::LessEq || op == Op::Greater || op == Op::GreaterEq;
+        if (field == "pages")
+        {
+            if (opText == "~")
+                return NodePtr(new TextNode(CatalogModel::PagesColumn, Op::Contains, value.text));
+            bool ok = false;
+            const int n = value.text.toInt(&ok);
+            if (!ok)
+                return fail(QObject::tr("'%1' is not a number").arg(value.text));
+            return NodePtr(new PagesNode(op == Op::Contains ? Op::Equals : op, n));
+        }
+        if (ordering)
+            return fail(QObject::tr("'%1' only applies to pages").arg(opText));
+        if (field == "author")
+            return NodePtr(new AuthorNode(op, value.text, m_pool));
+        if (field == "name" || field == "title")
+            return NodePtr(new TextNode(CatalogModel::NameColumn, op, value.text));
+        return fail(QObject::tr("Unknown field '%1'").arg(t.text));
+    }
+
+    NodePtr anyColumn(const QString& needle)
+    {
+        std::unique_ptr<ListNode> list(new ListNode(false));
+        list->children.push_back(NodePtr(new AuthorNode(Op::Contains, needle, m_pool)));
+        list->children.push_back(NodePtr(new TextNode(CatalogModel::NameColumn,  Op::Contains, needle)));
+        list->children.push_back(NodePtr(new TextNode(CatalogModel::PagesColumn, Op::Contains, needle)));
+        return NodePtr(list.release());
+    }
+
+    NodePtr collapse(std::unique_ptr<ListNode> list)
+    {
+        if (list->children.size() == 1)
+            return std::move(list->children.front());
+        list->finish();
+        return NodePtr(list.release());
+    }
+
+    NodePtr fail(const QString& message)
+    {
+        if (m_error.isEmpty())
+            m_error = message;
+        return NodePtr(new ListNode(true));
+    }
+
+    const AuthorPool&   m_pool;
+    QVector<Token>      m_tokens;
+    int                 m_pos = 0;
+    QString             m_error;
+};
+
+} // namespace
+
+CatalogQuery CatalogQuery::compile(const QString& text, const AuthorPool& pool, QString* error)
+{
+    CatalogQuery q;
+    Parser parser(text, pool);
+    NodePtr root = parser.parse(error);
+    if (root)
+        q.m_root = std::shared_ptr<const Node>(root.release());
+    return q;
+}
+
+bool CatalogQuery::looksStructured(const QString& text)
+{
+    // Field names are case-insensitive, the boolean keywords are not, so
+    // "war and peace" stays an ordinary substring search. Parentheses and
+    // quotes alone do not count: "Dune (1965)" is a title, not a group.
+    static const QRegularExpression re(
+        QStringLiteral("(?i:\\b(name|title|author|pages)\\s*(:|~|=|!=|<|>))|\\b(AND|OR|NOT)\\b"));
+    return re.match(text).hasMatch();
+}
+
+bool CatalogQuery::matches(const CatalogModel* model, int row) const
+{
+    return !m_root || m_root->eval(model, row);
+}
+
+bool CatalogQuery::matches(const CatalogStore::Row& row) const
+{
+    return !m_root || m_root->eval(row);
+}
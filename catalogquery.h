@@ -0,0 +1,41 @@
+#ifndef CATALOGQUERY_H
+#define CATALOGQUERY_H
+
+#include <QString>
+#include <QVector>
+#include <memory>
+
+#include "catalogmodel.h"
+
+// Column-scoped search expression, compiled once into a predicate tree:
+//
+//   author:tolstoy pages>300 name~"war"   (terms side by side are ANDed)
+//   author="Leo Tolstoy" OR NOT (pages<=100)
+//
+// Fields are name, author and pages. ':' and '~' test for a substring, '='
+// and '!=' for the whole value; pages also takes < <= > >= as integers.
+// Author terms are resolved against the author pool while compiling, so
+// rows are tested by id. Bare words match any column.
+//
+// AuthorIndex is not used to pick candidate rows: the proxy offers every
+// source row to the filter anyway, the server scans snapshots whose rows
+// are not index items, and an id lookup is as cheap as a set lookup.
+class CatalogQuery
+{
+public:
+    struct Node;
+
+    CatalogQuery() = default;
+
+    static CatalogQuery compile(const QString& text, const AuthorPool& pool, QString* error = nullptr);
+    static bool looksStructured(const QString& text);
+
+    bool isValid() const    { return m_root != nullptr; }
+    bool matches(const CatalogModel* model, int row) const;
+    bool matches(const CatalogStore::Row& row) const;
+
+private:
+    std::shared_ptr<const Node> m_root;
+};
+
+#endif // CATALOGQUERY_H
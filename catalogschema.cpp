@@ -0,0 +1,187 @@
+#include "catalogschema.h"
+
+#include <QtConcurrent>
+#include <QRegularExpression>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+const int ChunkRows = 16384;
+
+typedef QVector<CatalogSchema::Issue> Issues;
+
+CatalogSchema::Issue makeIssue(int line, int row, int column, CatalogSchema::Problem problem)
+{
+    CatalogSchema::Issue issue;
+    issue.line    = line;
+    issue.row     = row;
+    issue.column  = quint8(column);
+    issue.problem = quint8(problem);
+    return issue;
+}
+
+void checkLine(const QString& line, int lineNo, int row, Issues& out)
+{
+    if (line.size() > CatalogSchema::MaxLineLength)
+        out << makeIssue(lineNo, row, CatalogModel::NameColumn, CatalogSchema::LineTooLong);
+
+    const int tab1 = line.indexOf('\t');
+    const int tab2 = tab1 < 0 ? -1 : line.indexOf('\t', tab1 + 1);
+    const int tab3 = tab2 < 0 ? -1 : line.indexOf('\t', tab2 + 1);
+    if (tab2 < 0 || tab3 >= 0)
+    {
+        out << makeIssue(lineNo, row, tab2 < 0 ? CatalogModel::PagesColumn : CatalogModel::NameColumn, CatalogSchema::FieldCount);
+        if (tab2 < 0) return;
+    }
+
+    const int end = tab3 < 0 ? line.size() : tab3;
+    CatalogSchema::Problem problem;
+    if (!CatalogSchema::checkPages(line.mid(tab2 + 1, end - tab2 - 1), &problem))
+        out << makeIssue(lineNo, row, CatalogModel::PagesColumn, problem);
+}
+
+QString cellText(const CatalogModel* model, int row, int column)
+{
+    const QStandardItem* it = model->item(row, column);
+    return it ? it->text() : QString();
+}
+
+QVector<int> chunkStarts(int rows)
+{
+    QVector<int> chunks;
+    for (int first = 0; first < rows; first += ChunkRows)
+        chunks << first;
+    return chunks;
+}
+
+void appendIssues(Issues& result, const Issues& part)
+{
+    result += part;
+}
+
+} // namespace
+
+QIntValidator* CatalogSchema::pagesValidator(QObject* parent)
+{
+    return new QIntValidator(MinPages, MaxPages, parent);
+}
+
+bool CatalogSchema::checkPages(const QString& text, Problem* problem)
+{
+    bool ok = false;
+    const qlonglong pages = text.toLongLong(&ok);
+    if (!ok)
+    {
+        if (problem) *problem = PagesNotNumber;
+        return false;
+    }
+    if (pages < MinPages || pages > MaxPages)
+    {
+        if (problem) *problem = PagesOutOfRange;
+        return false;
+    }
+    return true;
+}
+
+// For rows that arrive as fields rather than as a line of the file: a tab
+// or line break inside a field would split the row once it is saved.
+bool CatalogSchema::checkRow(const QString& name, const QString& author, const QString& pages, Problem* problem)
+{
+    static const QRegularExpression separator(QStringLiteral("[\\t\\r\\n]"));
+    if (name.contains(separator) || author.contains(separator) || pages.contains(separator))
+    {
+        if (problem) *problem = FieldCount;
+        return false;
+    }
+    if (name.size() + author.size() + pages.size() + 2 > MaxLineLength)
+    {
+        if (problem) *problem = LineTooLong;
+        return false;
+    }
+    return checkPages(pages, problem);
+}
+
+QString CatalogSchema::describe(Problem problem)
+{
+    switch (problem)
+    {
+        case FieldCount:      return QObject::tr("Expected 3 tab-separated fields");
+        case PagesNotNumber:  return QObject::tr("Pages is not a number");
+        case PagesOutOfRange: return QObject::tr("Pages must be between %1 and %2").arg(MinPages).arg(MaxPages);
+        case LineTooLong:     return QObject::tr("Line longer than %1 characters").arg(MaxLineLength);
+    }
+    return QString();
+}
+
+QFuture<QVector<CatalogSchema::Issue>> CatalogSchema::validateLines(const QStringList& lines, const QVector<int>& lineNumbers,
+                                                                    int firstRow)
+{
+    const int rows = lines.size();
+    auto check = [lines, lineNumbers, rows, firstRow](int first) -> Issues {
+        Issues issues;
+        const int last = std::min(first + ChunkRows, rows);
+        for (int r = first; r < last; ++r)
+            checkLine(lines[r], lineNumbers[r], firstRow + r, issues);
+        return issues;
+    };
+    return QtConcurrent::mappedReduced<Issues>(chunkStarts(rows), check, appendIssues,
+                                               QtConcurrent::OrderedReduce);
+}
+
+QVector<CatalogSchema::Issue> CatalogSchema::validateModel(const CatalogModel* model)
+{
+    // The workers check a snapshot, a block at a time; the items stay with
+    // the GUI thread.
+    const CatalogStore::Snapshot snapshot = model->snapshot();
+    QVector<int> blocks(snapshot.blockCount());
+    std::iota(blocks.begin(), blocks.end(), 0);
+    auto check = [&snapshot](int b) -> Issues {
+        Issues issues;
+        const QVector<CatalogStore::Row>& block = snapshot.block(b);
+        const int start = snapshot.blockStart(b);
+        for (int i = 0; i < block.size(); ++i)
+        {
+            const CatalogStore::Row& row = block.at(i);
+            if (row.name.size() + row.author.size() + row.pages.size() + 2 > MaxLineLength)
+                issues << makeIssue(0, start + i, CatalogModel::NameColumn, LineTooLong);
+            Problem problem;
+            if (!checkPages(row.pages, &problem))
+                issues << makeIssue(0, start + i, CatalogModel::PagesColumn, problem);
+        }
+        return issues;
+    };
+    return QtConcurrent::blockingMappedReduced<Issues>(blocks, check, appendIssues,
+                                                       QtConcurrent::OrderedReduce);
+}
+
+QString CatalogSchema::fixedValue(const CatalogModel* model, const Issue& issue)
+{
+    const QString text = cellText(model, issue.row, issue.column);
+    switch (Problem(issue.problem))
+    {
+        case PagesNotNumber:
+        case PagesOutOfRange:
+        {
+            // Only a plain count out of range is clamped. Anything else
+            // ("abc", "12,5", "-3") is left for the user, since any value
+            // made up from it would be a different, valid number.
+            const QString digits = text.trimmed();
+            if (digits.isEmpty() || !std::all_of(digits.begin(), digits.end(),
+                                                 [](QChar ch) { return ch >= '0' && ch <= '9'; }))
+                return QString();
+            bool ok = false;
+            const qlonglong pages = digits.toLongLong(&ok);
+            return QString::number(ok ? qBound<qlonglong>(MinPages, pages, MaxPages) : MaxPages);
+        }
+        case LineTooLong:
+        {
+            const int length = cellText(model, issue.row, CatalogModel::NameColumn).size()
+                             + cellText(model, issue.row, CatalogModel::AuthorColumn).size()
+                             + cellText(model, issue.row, CatalogModel::PagesColumn).size() + 2;
+            return text.left(std::max(0, int(text.size()) - (length - MaxLineLength)));
+        }
+        default:
+            return QString();
+    }
+}
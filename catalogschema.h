@@ -0,0 +1,47 @@
+#ifndef CATALOGSCHEMA_H
+#define CATALOGSCHEMA_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QFuture>
+#include <QIntValidator>
+
+#include "catalogmodel.h"
+
+// Rules a catalog row has to satisfy. PositiveIntDelegate uses them for the
+// Pages editor, ContentWindow::read() checks every loaded line against them.
+class CatalogSchema
+{
+public:
+    static constexpr int MinPages      = 1;
+    static constexpr int MaxPages      = 1000000000;
+    static constexpr int MaxLineLength = 4096;
+
+    enum Problem : quint8 { FieldCount, PagesNotNumber, PagesOutOfRange, LineTooLong };
+
+    struct Issue
+    {
+        int     line;       // 1-based line in the source file, 0 if unknown
+        int     row;        // model row at the time of the check
+        quint8  column;
+        quint8  problem;
+    };
+
+    static QIntValidator* pagesValidator(QObject* parent);
+    static bool checkPages(const QString& text, Problem* problem = nullptr);
+    static bool checkRow(const QString& name, const QString& author, const QString& pages,
+                         Problem* problem = nullptr);
+    static QString describe(Problem problem);
+
+    // Checks the lines of a file in chunks on the global thread pool; rows
+    // are the positions of the non-empty lines, counted from firstRow.
+    static QFuture<QVector<Issue>> validateLines(const QStringList& lines, const QVector<int>& lineNumbers,
+                                                 int firstRow = 0);
+    static QVector<Issue> validateModel(const CatalogModel* model);
+
+    // Suggested replacement for a cell reported by an issue, or a null string.
+    static QString fixedValue(const CatalogModel* model, const Issue& issue);
+};
+
+#endif // CATALOGSCHEMA_H
@@ -0,0 +1,363 @@
+#include "catalogserver.h"
+#include "catalogquery.h"
+#include "catalogschema.h"
+#include "loghandler.h"
+
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+
+using namespace CatalogProtocol;
+
+namespace {
+
+QByteArray reply(quint32 id, Status status, const std::function<void(QDataStream&)>& body)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << id << quint8(status);
+    body(out);
+    return payload;
+}
+
+QByteArray errorReply(quint32 id, const QString& error)
+{
+    return reply(id, Error, [&](QDataStream& out) { out << error; });
+}
+
+void appendIndices(QVector<int>& result, const QVector<int>& part)
+{
+    result += part;
+}
+
+} // namespace
+
+CatalogServer::CatalogServer(CatalogModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+{
+    m_flush.setSingleShot(true);
+    m_flush.setInterval(0);
+    connect(&m_flush, &QTimer::timeout, this, &CatalogServer::flushInserts);
+    connect(&m_server, &QLocalServer::newConnection, this, &CatalogServer::accept);
+}
+
+bool CatalogServer::listen(const QString& name)
+{
+    m_server.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_server.listen(name) && m_server.serverError() == QAbstractSocket::AddressInUseError)
+    {
+        // A name nobody answers on is a socket file left by a crashed
+        // instance; a live one keeps it.
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (probe.waitForConnected(500))
+        {
+            qDebug(logWarning()) << "Catalog server: another instance is already serving" << name;
+            return false;
+        }
+        QLocalServer::removeServer(name);
+        m_server.listen(name);
+    }
+    if (!m_server.isListening())
+    {
+        qDebug(logWarning()) << "Catalog server cannot listen on" << name << ":" << m_server.errorString();
+        return false;
+    }
+    qDebug(logInfo()) << "Catalog server listening on" << m_server.fullServerName();
+    return true;
+}
+
+void CatalogServer::close()
+{
+    flushInserts();
+    const QList<QLocalSocket*> sockets = m_connections.keys();
+    for (QLocalSocket* socket : sockets)
+    {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    m_connections.clear();
+    m_server.close();
+}
+
+void CatalogServer::accept()
+{
+    while (m_server.hasPendingConnections())
+    {
+        QLocalSocket* socket = m_server.nextPendingConnection();
+        m_connections.insert(socket, Connection());
+        connect(socket, &QLocalSocket::readyRead,    this, [this, socket]() { read(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { drop(socket); });
+    }
+}
+
+void CatalogServer::drop(QLocalSocket* socket)
+{
+    // Rows it already sent are still inserted; only the reply is lost.
+    m_connections.remove(socket);
+    socket->deleteLater();
+}
+
+void CatalogServer::read(QLocalSocket* socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) return;
+    Connection& c = it.value();
+
+    c.in += socket->readAll();
+    QByteArray payload;
+    bool tooLarge = false;
+    while (takeFrame(c.in, c.offset, &payload, &tooLarge))
+        handle(socket, c, payload);
+    c.in.remove(0, c.offset);
+    c.offset = 0;
+
+    if (tooLarge)
+    {
+        qDebug(logWarning()) << "Catalog server: oversized frame, closing the connection.";
+        socket->abort();
+        return;
+    }
+    send(socket, c);
+}
+
+void CatalogServer::send(QLocalSocket* socket, Connection& c)
+{
+    if (c.out.isEmpty()) return;
+    socket->write(c.out);
+    c.out.clear();
+}
+
+// Replies go out in request order: behind a query still scanning, they wait.
+void CatalogServer::respond(Connection& c, const QByteArray& answer)
+{
+    if (c.queued.isEmpty())
+        appendFrame(c.out, answer);
+    else
+        c.queued.append({ QFuture<QByteArray>(), answer, false });
+}
+
+void CatalogServer::defer(QLocalSocket* socket, Connection& c, const QFuture<QByteArray>& future)
+{
+    c.queued.append({ future, QByteArray(), true });
+    auto* watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, socket, watcher]() {
+        watcher->deleteLater();
+        drain(socket);
+    });
+    watcher->setFuture(future);
+}
+
+void CatalogServer::drain(QLocalSocket* socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) return;
+    Connection& c = it.value();
+    while (!c.queued.isEmpty() && (!c.queued.first().deferred || c.queued.first().future.isFinished()))
+    {
+        const Queued q = c.queued.takeFirst();
+        appendFrame(c.out, q.deferred ? q.future.result() : q.answer);
+    }
+    send(socket, c);
+}
+
+void CatalogServer::handle(QLocalSocket* socket, Connection& c, const QByteArray& payload)
+{
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 id = 0;
+    quint8 op = 0;
+    in >> id >> op;
+
+    // Later requests must see earlier inserts, and their replies must not
+    // overtake the insert's.
+    if (op != Insert && !m_pendingReplies.isEmpty())
+        flushInserts();
+
+    QByteArray answer;
+    switch (op)
+    {
+    case Count:
+        answer = reply(id, Ok, [&](QDataStream& out) { out << qint32(m_model->rowCount()); });
+        break;
+
+    case Query:
+    {
+        QString text;
+        qint32 limit = 0;
+        in >> text >> limit;
+        if (in.status() != QDataStream::Ok) break;
+        const CatalogStore::Snapshot snapshot = m_model->snapshot();
+        defer(socket, c, match(snapshot, text).then([id, limit, snapshot](const QVector<int>& rows) {
+            const int n = qBound(0, int(limit), int(rows.size()));
+            return reply(id, Ok, [&](QDataStream& out) {
+                out << qint32(rows.size()) << qint32(n);
+                for (int i = 0; i < n; ++i)
+                    writeRow(out, snapshot, rows[i]);
+            });
+        }));
+        return;
+    }
+
+    case Lookup:
+    {
+        qint32 n = 0;
+        in >> n;
+        if (in.status() != QDataStream::Ok || n < 0 || n > payload.size() / 4) break;
+        QVector<qint32> rows(n);
+        for (qint32& row : rows)
+            in >> row;
+        if (in.status() != QDataStream::Ok) break;
+        const CatalogStore::Snapshot snapshot = m_model->snapshot();
+        answer = reply(id, Ok, [&](QDataStream& out) {
+            out << n;
+            for (qint32 row : rows)
+                writeRow(out, snapshot, row);
+        });
+        break;
+    }
+
+    case Insert:
+    {
+        // A row takes at least its three string lengths, so the count is
+        // checked against the payload before anything is allocated.
+        qint32 n = 0;
+        in >> n;
+        if (in.status() != QDataStream::Ok || n < 0 || n > payload.size() / MinRowBytes) break;
+        if (n > MaxPendingRows)
+        {
+            answer = errorReply(id, tr("At most %1 rows per insert").arg(MaxPendingRows));
+            break;
+        }
+        if (m_pendingRows.size() + n > MaxPendingRows)
+            flushInserts();
+
+        // Rows are held to the same rules as a loaded file; a request with
+        // a bad row is refused whole.
+        const int first = m_pendingRows.size();
+        Row row;
+        CatalogSchema::Problem problem;
+        for (int i = 0; i < n && in.status() == QDataStream::Ok; ++i)
+        {
+            in >> row;
+            if (in.status() == QDataStream::Ok && !CatalogSchema::checkRow(row.name, row.author, row.pages, &problem))
+            {
+                answer = errorReply(id, tr("Row %1: %2").arg(i + 1).arg(CatalogSchema::describe(problem)));
+                break;
+            }
+            m_pendingRows.append(row);
+        }
+        if (in.status() != QDataStream::Ok || !answer.isEmpty())
+        {
+            m_pendingRows.resize(first);
+            break;
+        }
+        m_pendingReplies.append({ socket, id, int(n) });
+        if (m_pendingRows.size() >= MaxPendingRows)
+            flushInserts();
+        else
+            m_flush.start();
+        return;
+    }
+
+    default:
+        answer = errorReply(id, tr("Unknown request %1").arg(op));
+        break;
+    }
+
+    // Only a refused insert gets here with inserts pending; they are
+    // answered first so replies stay in order.
+    if (!m_pendingReplies.isEmpty())
+        flushInserts();
+    if (answer.isEmpty())
+        answer = errorReply(id, tr("Malformed request"));
+    respond(c, answer);
+}
+
+void CatalogServer::flushInserts()
+{
+    m_flush.stop();
+    if (m_pendingReplies.isEmpty()) return;
+
+    QElapsedTimer timer;
+    timer.start();
+    int next = m_model->rowCount();
+
+    QVector<QList<QStandardItem*>> rows;
+    rows.reserve(m_pendingRows.size());
+    for (const Row& row : m_pendingRows)
+        rows.append(m_model->makeRow(row.name, row.author, row.pages));
+    m_model->appendRows(rows);
+
+    for (const PendingInsert& p : m_pendingReplies)
+    {
+        auto it = m_connections.find(p.socket);
+        if (it != m_connections.end())
+        {
+            const int first = next;
+            respond(it.value(), reply(p.id, Ok, [&](QDataStream& out) { out << qint32(first) << qint32(p.count); }));
+        }
+        next += p.count;
+    }
+    for (auto it = m_connections.begin(); it != m_connections.end(); ++it)
+        send(it.key(), it.value());
+
+    const int count = rows.size();
+    qDebug(logDebug()) << "Catalog server appended" << count << "rows from" << m_pendingReplies.size()
+                       << "requests in" << timer.elapsed() << "ms.";
+    m_pendingRows.clear();
+    m_pendingReplies.clear();
+    emit rowsAppended(count);
+}
+
+// Compiles the query here, against the current author pool, and scans the
+// snapshot on the thread pool.
+QFuture<QVector<int>> CatalogServer::match(const CatalogStore::Snapshot& rows, const QString& text) const
+{
+    QVector<int> blocks(rows.blockCount());
+    std::iota(blocks.begin(), blocks.end(), 0);
+
+    QString error;
+    const CatalogQuery query = CatalogQuery::looksStructured(text)
+                                   ? CatalogQuery::compile(text, m_model->authors(), &error)
+                                   : CatalogQuery();
+
+    // Same rules as the search bar, applied to a snapshot block by block.
+    auto scan = [rows, text, query](int b) -> QVector<int> {
+        QVector<int> hits;
+        const QVector<CatalogStore::Row>& block = rows.block(b);
+        const int start = rows.blockStart(b);
+        for (int i = 0; i < block.size(); ++i)
+        {
+            const CatalogStore::Row& row = block.at(i);
+            bool hit = text.isEmpty();
+            if (!hit && query.isValid())
+                hit = query.matches(row);
+            else
+                for (int c = 0; c < CatalogModel::ColumnCount && !hit; ++c)
+                    hit = row.text(c).contains(text, Qt::CaseInsensitive);
+            if (hit)
+                hits.append(start + i);
+        }
+        return hits;
+    };
+    return QtConcurrent::mappedReduced<QVector<int>>(std::move(blocks), scan, appendIndices,
+                                                     QtConcurrent::OrderedReduce);
+}
+
+void CatalogServer::writeRow(QDataStream& out, const CatalogStore::Snapshot& rows, int row)
+{
+    if (row < 0 || row >= rows.rowCount())
+    {
+        out << qint32(-1) << Row();
+        return;
+    }
+    const CatalogStore::Row& r = rows.row(row);
+    out << qint32(row) << Row{ r.name, r.author, r.pages };
+}
@@ -0,0 +1,82 @@
+#ifndef CATALOGSERVER_H
+#define CATALOGSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QHash>
+#include <QTimer>
+#include <QFuture>
+#include <QVector>
+
+#include "catalogmodel.h"
+#include "catalogprotocol.h"
+
+// Serves the open catalog to other processes over a local socket (see
+// catalogprotocol.h). Requests are decoded as they arrive and answered with
+// one write per read. Queries scan a snapshot on the thread pool; replies
+// behind one are held per connection until it is done, so they keep their
+// order. Inserts from all clients are collected until control
+// returns to the event loop and then appended as a single block, so a burst
+// of small inserts costs one model update. The socket is only open to the
+// user running the application.
+class CatalogServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CatalogServer(CatalogModel* model, QObject* parent = nullptr);
+
+    bool listen(const QString& name);
+    void close();
+    bool isListening() const    { return m_server.isListening(); }
+
+signals:
+    void rowsAppended(int count);
+
+private:
+    static constexpr int MaxPendingRows = 65536;
+
+    struct Queued
+    {
+        QFuture<QByteArray> future;     // a query still scanning
+        QByteArray          answer;     // or a reply waiting behind one
+        bool                deferred = false;
+    };
+
+    struct Connection
+    {
+        QByteArray      in;
+        int             offset = 0;
+        QByteArray      out;
+        QList<Queued>   queued;
+    };
+
+    struct PendingInsert
+    {
+        QLocalSocket* socket;
+        quint32       id;
+        int           count;
+    };
+
+    void accept();
+    void read(QLocalSocket* socket);
+    void drop(QLocalSocket* socket);
+    void send(QLocalSocket* socket, Connection& c);
+    void respond(Connection& c, const QByteArray& answer);
+    void defer(QLocalSocket* socket, Connection& c, const QFuture<QByteArray>& future);
+    void drain(QLocalSocket* socket);
+    void handle(QLocalSocket* socket, Connection& c, const QByteArray& payload);
+    void flushInserts();
+    QFuture<QVector<int>> match(const CatalogStore::Snapshot& rows, const QString& text) const;
+    static void writeRow(QDataStream& out, const CatalogStore::Snapshot& rows, int row);
+
+    CatalogModel*                       m_model;
+    QLocalServer                        m_server;
+    QHash<QLocalSocket*, Connection>    m_connections;
+    QTimer                              m_flush;
+    QVector<CatalogProtocol::Row>       m_pendingRows;
+    QVector<PendingInsert>              m_pendingReplies;
+};
+
+#endif // CATALOGSERVER_H
@@ -0,0 +1,116 @@
+#include "catalogstats.h"
+
+#include <QSignalBlocker>
+#include <algorithm>
+
+CatalogStats::CatalogStats(CatalogModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+{
+    connect(m_model, &CatalogModel::rowAboutToChange, this, &CatalogStats::retractRow);
+    connect(m_model, &CatalogModel::rowChanged,       this, &CatalogStats::addRow);
+    connect(m_model, &QAbstractItemModel::rowsInserted,
+            this, &CatalogStats::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &CatalogStats::onRowsAboutToBeRemoved);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &CatalogStats::recompute);
+    recompute();
+}
+
+const CatalogStats::Aggregate& CatalogStats::author(int id) const
+{
+    static const Aggregate empty;
+    return (id >= 0 && id < m_authors.size()) ? m_authors[id] : empty;
+}
+
+void CatalogStats::recompute()
+{
+    {
+        const QSignalBlocker blocker(this);
+        m_total = Aggregate();
+        m_authors.clear();
+        for (int r = 0; r < m_model->rowCount(); ++r)
+            apply(r, +1);
+    }
+    emit reset();
+}
+
+void CatalogStats::retractRow(int row)
+{
+    const int id = apply(row, -1);
+    if (id >= 0)
+        emit authorChanged(id);
+}
+
+void CatalogStats::addRow(int row)
+{
+    const int id = apply(row, +1);
+    if (id >= 0)
+        emit authorChanged(id);
+    emit totalChanged();
+}
+
+// Returns the row's author id, or -1.
+int CatalogStats::apply(int row, int sign)
+{
+    bool hasPages = false;
+    int pages = 0;
+    if (const QStandardItem* it = m_model->item(row, CatalogModel::PagesColumn))
+        pages = it->text().toInt(&hasPages);
+
+    accumulate(m_total, hasPages, pages, sign);
+
+    const int id = m_model->authorId(row);
+    if (id < 0) return -1;
+    if (id >= m_authors.size())
+        m_authors.resize(m_model->authors().size());
+    accumulate(m_authors[id], hasPages, pages, sign);
+    return id;
+}
+
+// A block of rows is reported once per author it touched, in id order, or
+// as a reset when it touched many.
+void CatalogStats::applyRange(int first, int last, int sign)
+{
+    QVector<int> touched;
+    for (int r = first; r <= last; ++r)
+    {
+        const int id = apply(r, sign);
+        if (id >= 0)
+            touched.append(id);
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    if (touched.size() > ResetAuthors)
+        emit reset();
+    else
+        for (int id : touched)
+            emit authorChanged(id);
+    emit totalChanged();
+}
+
+void CatalogStats::accumulate(Aggregate& a, bool hasPages, int pages, int sign)
+{
+    a.books += sign;
+    if (!hasPages) return;
+
+    a.pagedBooks += sign;
+    a.pages      += qint64(sign) * pages;
+    int& n = a.pageCounts[pages];
+    n += sign;
+    if (n <= 0)
+        a.pageCounts.remove(pages);
+}
+
+void CatalogStats::onRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    applyRange(first, last, +1);
+}
+
+void CatalogStats::onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    applyRange(first, last, -1);
+}
@@ -0,0 +1,61 @@
+#ifndef CATALOGSTATS_H
+#define CATALOGSTATS_H
+
+#include <QObject>
+#include <QVector>
+#include <QMap>
+
+#include "catalogmodel.h"
+
+// Books/pages aggregates kept up to date from CatalogModel's change signals.
+// Every edit, insert and removal only touches the rows involved; the whole
+// catalog is scanned once, after a load resets the model.
+class CatalogStats : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Aggregate
+    {
+        int         books      = 0;   // rows, whatever their Pages value
+        int         pagedBooks = 0;   // rows with a numeric Pages value
+        qint64      pages      = 0;
+        QMap<int,int> pageCounts;     // Pages value -> rows, for min/max
+
+        double average() const  { return pagedBooks ? double(pages) / pagedBooks : 0.0; }
+        int    minPages() const { return pageCounts.isEmpty() ? 0 : pageCounts.firstKey(); }
+        int    maxPages() const { return pageCounts.isEmpty() ? 0 : pageCounts.lastKey(); }
+    };
+
+    explicit CatalogStats(CatalogModel* model, QObject* parent = nullptr);
+
+    const Aggregate& total() const { return m_total; }
+    const Aggregate& author(int id) const;
+    int authorCount() const        { return m_authors.size(); }
+
+    void recompute();
+
+signals:
+    void authorChanged(int id);
+    void totalChanged();
+    void reset();
+
+private:
+    static constexpr int ResetAuthors = 256;
+
+    void retractRow(int row);
+    void addRow(int row);
+    int  apply(int row, int sign);
+    void applyRange(int first, int last, int sign);
+
+    void onRowsInserted(const QModelIndex& parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+
+    static void accumulate(Aggregate& a, bool hasPages, int pages, int sign);
+
+    CatalogModel*       m_model;
+    Aggregate           m_total;
+    QVector<Aggregate>  m_authors;
+};
+
+#endif // CATALOGSTATS_H
@@ -0,0 +1,144 @@
+#include "catalogstore.h"
+
+#include <algorithm>
+
+// Columns are in CatalogModel order: name, author, pages.
+const QString& CatalogStore::Row::text(int column) const
+{
+    static const QString none;
+    switch (column)
+    {
+        case 0:  return name;
+        case 1:  return author;
+        case 2:  return pages;
+        default: return none;
+    }
+}
+
+const CatalogStore::Row& CatalogStore::Snapshot::row(int r) const
+{
+    Q_ASSERT(r >= 0 && r < m_rows);
+    int offset = 0;
+    const int b = locate(r, &offset);
+    return m_blocks.at(b).at(offset);
+}
+
+int CatalogStore::Snapshot::locate(int row, int* offset) const
+{
+    const auto it = std::upper_bound(m_starts.cbegin(), m_starts.cend(), row);
+    const int b = int(it - m_starts.cbegin()) - 1;
+    *offset = row - m_starts.at(b);
+    return b;
+}
+
+void CatalogStore::Snapshot::updateStarts(int from)
+{
+    m_starts.resize(m_blocks.size());
+    int start = from > 0 ? m_starts.at(from - 1) + m_blocks.at(from - 1).size() : 0;
+    for (int b = from; b < m_blocks.size(); ++b)
+    {
+        m_starts[b] = start;
+        start += m_blocks.at(b).size();
+    }
+    m_rows = start;
+}
+
+void CatalogStore::split(const QVector<Row>& rows, QVector<QVector<Row>>& blocks)
+{
+    for (int i = 0; i < rows.size(); i += BlockRows)
+        blocks.append(rows.mid(i, BlockRows));
+}
+
+void CatalogStore::reset(const QVector<Row>& rows)
+{
+    ++m_head.m_version;
+    m_head.m_blocks.clear();
+    split(rows, m_head.m_blocks);
+    m_head.updateStarts(0);
+}
+
+void CatalogStore::insert(int row, const QVector<Row>& rows)
+{
+    if (rows.isEmpty()) return;
+    Snapshot& h = m_head;
+    ++h.m_version;
+
+    if (h.m_blocks.isEmpty())
+    {
+        split(rows, h.m_blocks);
+        h.updateStarts(0);
+        return;
+    }
+
+    int offset = 0;
+    int b = 0;
+    if (row >= h.m_rows)
+    {
+        b = h.m_blocks.size() - 1;
+        offset = h.m_blocks.at(b).size();
+    }
+    else
+        b = h.locate(qMax(row, 0), &offset);
+
+    // Only the receiving block is rebuilt; an oversized one is cut into
+    // fresh blocks so later edits keep copying little.
+    const QVector<Row>& old = h.m_blocks.at(b);
+    QVector<Row> merged;
+    merged.reserve(old.size() + rows.size());
+    merged << old.mid(0, offset) << rows << old.mid(offset);
+
+    if (merged.size() <= 2 * BlockRows)
+        h.m_blocks[b] = merged;
+    else
+    {
+        QVector<QVector<Row>> pieces;
+        split(merged, pieces);
+        h.m_blocks = h.m_blocks.mid(0, b) + pieces + h.m_blocks.mid(b + 1);
+    }
+    h.updateStarts(b);
+}
+
+void CatalogStore::remove(int row, int count)
+{
+    Snapshot& h = m_head;
+    count = qMin(count, h.m_rows - row);
+    if (row < 0 || count <= 0) return;
+    ++h.m_version;
+
+    int offset = 0;
+    const int first = h.locate(row, &offset);
+    int b = first;
+    while (count > 0)
+    {
+        const int size = h.m_blocks.at(b).size();
+        const int n = qMin(count, size - offset);
+        if (n == size)
+            h.m_blocks.remove(b);
+        else
+        {
+            h.m_blocks[b].remove(offset, n);
+            ++b;
+        }
+        offset = 0;
+        count -= n;
+    }
+    h.updateStarts(first);
+}
+
+void CatalogStore::setText(int row, int column, const QString& text, int authorId)
+{
+    Snapshot& h = m_head;
+    if (row < 0 || row >= h.m_rows) return;
+    ++h.m_version;
+
+    int offset = 0;
+    const int b = h.locate(row, &offset);
+    Row& r = h.m_blocks[b][offset];
+    switch (column)
+    {
+        case 0: r.name = text; break;
+        case 1: r.author = text; r.authorId = authorId; break;
+        case 2: r.pages = text; break;
+        default: break;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef CATALOGSTORE_H
+#define CATALOGSTORE_H
+
+#include <QString>
+#include <QVector>
+
+// Row storage kept in blocks of about BlockRows rows. Blocks and the block
+// list are implicitly shared, so a Snapshot is a constant-time copy that
+// other threads may read without locking while the store keeps changing:
+// an edit detaches only the block list and the one block it touches, and
+// the snapshot goes on seeing the old ones.
+class CatalogStore
+{
+public:
+    struct Row
+    {
+        QString name;
+        QString author;
+        QString pages;
+        int     authorId = -1;
+
+        const QString& text(int column) const;
+    };
+
+    class Snapshot
+    {
+    public:
+        int     rowCount() const    { return m_rows; }
+        quint64 version() const     { return m_version; }
+        const Row& row(int r) const;
+
+        // Sequential readers walk the blocks instead of calling row().
+        int blockCount() const                      { return m_blocks.size(); }
+        int blockStart(int block) const             { return m_starts[block]; }
+        const QVector<Row>& block(int block) const  { return m_blocks[block]; }
+
+    private:
+        friend class CatalogStore;
+
+        int locate(int row, int* offset) const;
+        void updateStarts(int from);
+
+        QVector<QVector<Row>> m_blocks;
+        QVector<int>          m_starts;
+        int                   m_rows    = 0;
+        quint64               m_version = 0;
+    };
+
+    Snapshot snapshot() const   { return m_head; }
+    int      rowCount() const   { return m_head.rowCount(); }
+    quint64  version() const    { return m_head.version(); }
+    const Row& row(int r) const { return m_head.row(r); }
+
+    void reset(const QVector<Row>& rows);
+    void insert(int row, const QVector<Row>& rows);
+    void remove(int row, int count);
+    void setText(int row, int column, const QString& text, int authorId = -1);
+
+private:
+    static constexpr int BlockRows = 512;
+
+    static void split(const QVector<Row>& rows, QVector<QVector<Row>>& blocks);
+
+    Snapshot m_head;
+};
+
+#endif // CATALOGSTORE_H
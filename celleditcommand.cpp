@@ -5,7 +5,7 @@ CellEditCommand::CellEditCommand(QStandardItemModel* model,
                   const QString& before,
                   const QString& after,
                   QUndoCommand* parent)
-    : QUndoCommand(parent)
+    : HistoryCommand(parent)
     , m(model), r(row), c(col)
     , oldValue(before), newValue(after)
 {
@@ -14,10 +14,87 @@ CellEditCommand::CellEditCommand(QStandardItemModel* model,
 
 void CellEditCommand::undo()
 {
+  if (muted()) return;
   m->setData(m->index(r,c), oldValue);
 }
 
 void CellEditCommand::redo() 
 {
+  if (muted()) return;
   m->setData(m->index(r,c), newValue);
-}
\ No newline at end of file
+}
+
+BatchEditCommand::BatchEditCommand(CatalogModel* model,
+                  const QVector<CatalogModel::CellChange>& changes,
+                  const QString& text,
+                  QUndoCommand* parent)
+    : HistoryCommand(parent)
+    , m(model), cells(changes)
+{
+  setText(text);
+}
+
+void BatchEditCommand::undo()
+{
+  if (muted()) return;
+  m->applyChanges(cells, false);
+}
+
+void BatchEditCommand::redo()
+{
+  if (muted()) return;
+  m->applyChanges(cells, true);
+}
+
+void CellEditCommand::write(QDataStream& out) const
+{
+  writeNumber(out, quint64(r));
+  writeNumber(out, quint64(c));
+  writeChange(out, oldValue, newValue);
+}
+
+CellEditCommand* CellEditCommand::read(QDataStream& in, CatalogModel* model)
+{
+  const int row = int(readNumber(in));
+  const int col = int(readNumber(in));
+  QString before, after;
+  readChange(in, &before, &after);
+  return new CellEditCommand(model, row, col, before, after);
+}
+
+// Rows are stored as the difference from the previous change's row, which
+// keeps sorted batches to a byte or two per cell.
+void BatchEditCommand::write(QDataStream& out) const
+{
+  writeText(out, text());
+  writeNumber(out, quint64(cells.size()));
+  int previous = 0;
+  for (const CatalogModel::CellChange& ch : cells)
+  {
+    writeDelta(out, ch.row - previous);
+    writeNumber(out, quint64(ch.column));
+    writeChange(out, ch.before, ch.after);
+    previous = ch.row;
+  }
+}
+
+BatchEditCommand* BatchEditCommand::read(QDataStream& in, CatalogModel* model)
+{
+  const QString text = readText(in);
+  const quint64 n = readNumber(in);
+  if (!in.device() || n > quint64(in.device()->bytesAvailable()))
+  {
+    in.setStatus(QDataStream::ReadCorruptData);
+    return nullptr;
+  }
+  QVector<CatalogModel::CellChange> changes(qsizetype(n));
+  int previous = 0;
+  for (CatalogModel::CellChange& ch : changes)
+  {
+    ch.row    = previous + int(readDelta(in));
+    ch.column = int(readNumber(in));
+    readChange(in, &ch.before, &ch.after);
+    previous  = ch.row;
+  }
+  return new BatchEditCommand(model, changes, text);
+}
@@ -0,0 +1,442 @@
+#include "compresseddevice.h"
+
+#include <QMutexLocker>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+CompressedDevice::CompressedDevice(const QString& path, QObject* parent)
+    : QIODevice(parent)
+    , m_file(path)
+{
+}
+
+CompressedDevice::~CompressedDevice()
+{
+    close();
+}
+
+CompressedDevice::Format CompressedDevice::detect(const QString& path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return Plain;
+    const QByteArray magic = f.read(4);
+    if (magic.startsWith("\x1f\x8b"))
+        return Gzip;
+    if (magic == QByteArray("\x28\xb5\x2f\xfd", 4))
+        return Zstd;
+    return Plain;
+}
+
+CompressedDevice::Format CompressedDevice::formatForName(const QString& path)
+{
+    if (path.endsWith(".gz", Qt::CaseInsensitive))
+        return Gzip;
+    if (path.endsWith(".zst", Qt::CaseInsensitive))
+        return Zstd;
+    return Plain;
+}
+
+bool CompressedDevice::isSupported(Format format)
+{
+    switch (format)
+    {
+#ifdef HAVE_ZLIB
+    case Gzip: return true;
+#endif
+#ifdef HAVE_ZSTD
+    case Zstd: return true;
+#endif
+    case Plain: return true;
+    default:    return false;
+    }
+}
+
+bool CompressedDevice::open(OpenMode mode)
+{
+    const bool reading = mode.testFlag(QIODevice::ReadOnly);
+    if (reading == mode.testFlag(QIODevice::WriteOnly))
+    {
+        setErrorString(tr("Compressed catalogs are opened either for reading or for writing"));
+        return false;
+    }
+
+    m_format = reading ? detect(m_file.fileName()) : formatForName(m_file.fileName());
+    if (!isSupported(m_format))
+    {
+        setErrorString(tr("This build cannot read or write %1 files").arg(m_format == Gzip ? "gzip" : "zstd"));
+        return false;
+    }
+
+    // Line ending translation happens in this device, the file stays raw.
+    if (!m_file.open(reading ? QIODevice::ReadOnly : QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        setErrorString(m_file.errorString());
+        return false;
+    }
+
+    m_queue.clear();
+    m_chunk.clear();
+    m_chunkPos = 0;
+    m_finished = m_cancel = m_failed = false;
+    m_error.clear();
+    QIODevice::open(mode);
+
+    if (m_format != Plain)
+    {
+        m_worker = QThread::create([this, reading]() {
+            if (reading)
+                decompress();
+            else
+                compress();
+        });
+        m_worker->start();
+    }
+    return true;
+}
+
+void CompressedDevice::close()
+{
+    if (!isOpen()) return;
+
+    if (m_worker)
+    {
+        {
+            QMutexLocker lock(&m_mutex);
+            if (openMode().testFlag(QIODevice::WriteOnly))
+            {
+                if (!m_chunk.isEmpty())
+                    m_queue.enqueue(m_chunk);
+                m_finished = true;
+                m_notEmpty.wakeAll();
+            }
+            else
+            {
+                m_cancel = true;
+                m_notFull.wakeAll();
+            }
+        }
+        m_chunk.clear();
+        m_worker->wait();
+        delete m_worker;
+        m_worker = nullptr;
+    }
+
+    if (!m_error.isEmpty())
+    {
+        m_failed = true;
+        setErrorString(m_error);
+    }
+    m_file.close();
+    if (m_file.error() != QFileDevice::NoError && !m_failed)
+    {
+        m_failed = true;
+        setErrorString(m_file.errorString());
+    }
+    QIODevice::close();
+}
+
+bool CompressedDevice::atEnd() const
+{
+    if (m_format == Plain)
+        return QIODevice::bytesAvailable() == 0 && m_file.atEnd();
+    if (QIODevice::bytesAvailable() > 0 || m_chunkPos < m_chunk.size())
+        return false;
+
+    // Whether more text follows is only known once the worker says so.
+    QMutexLocker lock(&m_mutex);
+    while (m_queue.isEmpty() && !m_finished)
+        m_notEmpty.wait(&m_mutex);
+    return m_queue.isEmpty();
+}
+
+qint64 CompressedDevice::bytesAvailable() const
+{
+    if (m_format == Plain)
+        return QIODevice::bytesAvailable() + m_file.bytesAvailable();
+    QMutexLocker lock(&m_mutex);
+    qint64 queued = 0;
+    for (const QByteArray& chunk : m_queue)
+        queued += chunk.size();
+    return QIODevice::bytesAvailable() + (m_chunk.size() - m_chunkPos) + queued;
+}
+
+qint64 CompressedDevice::readData(char* data, qint64 maxSize)
+{
+    if (m_format == Plain)
+    {
+        const qint64 n = m_file.read(data, maxSize);
+        return n == 0 ? -1 : n;
+    }
+
+    qint64 done = 0;
+    while (done < maxSize)
+    {
+        if (m_chunkPos == m_chunk.size())
+        {
+            // Block only while nothing has been handed out yet.
+            QMutexLocker lock(&m_mutex);
+            while (m_queue.isEmpty() && !m_finished && done == 0)
+                m_notEmpty.wait(&m_mutex);
+            if (m_queue.isEmpty())
+                break;
+            m_chunk    = m_queue.dequeue();
+            m_chunkPos = 0;
+            m_notFull.wakeOne();
+        }
+        const qint64 n = qMin(maxSize - done, qint64(m_chunk.size() - m_chunkPos));
+        std::memcpy(data + done, m_chunk.constData() + m_chunkPos, size_t(n));
+        m_chunkPos += int(n);
+        done       += n;
+    }
+
+    if (done == 0)
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!m_error.isEmpty())
+            setErrorString(m_error);
+        return -1;
+    }
+    return done;
+}
+
+qint64 CompressedDevice::writeData(const char* data, qint64 maxSize)
+{
+    if (m_format == Plain)
+        return m_file.write(data, maxSize);
+
+    qint64 done = 0;
+    while (done < maxSize)
+    {
+        const qint64 n = qMin(maxSize - done, qint64(ChunkBytes - m_chunk.size()));
+        m_chunk.append(data + done, int(n));
+        done += n;
+        if (m_chunk.size() == ChunkBytes)
+        {
+            if (!push(m_chunk))
+            {
+                QMutexLocker lock(&m_mutex);
+                setErrorString(m_error);
+                return -1;
+            }
+            m_chunk.clear();
+        }
+    }
+    return done;
+}
+
+bool CompressedDevice::push(const QByteArray& chunk)
+{
+    QMutexLocker lock(&m_mutex);
+    while (m_queue.size() >= MaxQueued && !m_cancel)
+        m_notFull.wait(&m_mutex);
+    if (m_cancel)
+        return false;
+    m_queue.enqueue(chunk);
+    m_notEmpty.wakeOne();
+    return true;
+}
+
+bool CompressedDevice::take(QByteArray* chunk)
+{
+    QMutexLocker lock(&m_mutex);
+    while (m_queue.isEmpty() && !m_finished)
+        m_notEmpty.wait(&m_mutex);
+    if (m_queue.isEmpty())
+        return false;
+    *chunk = m_queue.dequeue();
+    m_notFull.wakeOne();
+    return true;
+}
+
+// Called on the worker; stops the other side instead of leaving it waiting.
+void CompressedDevice::fail(const QString& error)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_error.isEmpty())
+        m_error = error;
+    m_finished = m_cancel = true;
+    m_notEmpty.wakeAll();
+    m_notFull.wakeAll();
+}
+
+void CompressedDevice::decompress()
+{
+    QByteArray in(ChunkBytes, Qt::Uninitialized);
+    bool ok = true;
+    bool complete = false;
+
+    switch (m_format)
+    {
+#ifdef HAVE_ZLIB
+    case Gzip:
+    {
+        z_stream zs;
+        std::memset(&zs, 0, sizeof(zs));
+        inflateInit2(&zs, 15 + 32);
+        int ret = Z_OK;
+        while (ok)
+        {
+            const qint64 n = m_file.read(in.data(), in.size());
+            if (n <= 0)
+            {
+                complete = n == 0 && ret == Z_STREAM_END;
+                break;
+            }
+            zs.next_in  = reinterpret_cast<Bytef*>(in.data());
+            zs.avail_in = uInt(n);
+            for (;;)
+            {
+                // A file may hold several gzip members back to back.
+                if (ret == Z_STREAM_END)
+                {
+                    if (zs.avail_in == 0) break;
+                    inflateReset(&zs);
+                }
+                QByteArray out(ChunkBytes, Qt::Uninitialized);
+                zs.next_out  = reinterpret_cast<Bytef*>(out.data());
+                zs.avail_out = uInt(out.size());
+                ret = inflate(&zs, Z_NO_FLUSH);
+                if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+                {
+                    ok = false;
+                    break;
+                }
+                out.truncate(out.size() - int(zs.avail_out));
+                if (!out.isEmpty() && !push(out))
+                {
+                    inflateEnd(&zs);
+                    return;
+                }
+                if (ret == Z_BUF_ERROR || (zs.avail_out != 0 && zs.avail_in == 0))
+                    break;
+            }
+        }
+        inflateEnd(&zs);
+        break;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    case Zstd:
+    {
+        ZSTD_DCtx* dctx = ZSTD_createDCtx();
+        size_t pending = 0;
+        while (ok)
+        {
+            const qint64 n = m_file.read(in.data(), in.size());
+            if (n <= 0)
+            {
+                complete = n == 0 && pending == 0;
+                break;
+            }
+            ZSTD_inBuffer input = { in.constData(), size_t(n), 0 };
+            while (input.pos < input.size)
+            {
+                QByteArray out(ChunkBytes, Qt::Uninitialized);
+                ZSTD_outBuffer output = { out.data(), size_t(out.size()), 0 };
+                pending = ZSTD_decompressStream(dctx, &output, &input);
+                if (ZSTD_isError(pending))
+                {
+                    ok = false;
+                    break;
+                }
+                out.truncate(int(output.pos));
+                if (!out.isEmpty() && !push(out))
+                {
+                    ZSTD_freeDCtx(dctx);
+                    return;
+                }
+            }
+        }
+        ZSTD_freeDCtx(dctx);
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+
+    if (!complete)
+    {
+        fail(tr("%1 is damaged or truncated").arg(m_file.fileName()));
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    m_finished = true;
+    m_notEmpty.wakeAll();
+}
+
+void CompressedDevice::compress()
+{
+    const auto put = [this](const char* data, qint64 size) {
+        return size == 0 || m_file.write(data, size) == size;
+    };
+    QByteArray out(ChunkBytes, Qt::Uninitialized);
+    QByteArray chunk;
+    bool ok = true;
+
+    switch (m_format)
+    {
+#ifdef HAVE_ZLIB
+    case Gzip:
+    {
+        z_stream zs;
+        std::memset(&zs, 0, sizeof(zs));
+        deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        bool more = true;
+        while (ok && more)
+        {
+            more = take(&chunk);
+            const int flush = more ? Z_NO_FLUSH : Z_FINISH;
+            zs.next_in  = reinterpret_cast<Bytef*>(chunk.data());
+            zs.avail_in = more ? uInt(chunk.size()) : 0;
+            int ret;
+            do
+            {
+                zs.next_out  = reinterpret_cast<Bytef*>(out.data());
+                zs.avail_out = uInt(out.size());
+                ret = deflate(&zs, flush);
+                ok = ret != Z_STREAM_ERROR && put(out.constData(), out.size() - int(zs.avail_out));
+            } while (ok && (zs.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END)));
+        }
+        deflateEnd(&zs);
+        break;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    case Zstd:
+    {
+        ZSTD_CCtx* cctx = ZSTD_createCCtx();
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, 3);
+        bool more = true;
+        while (ok && more)
+        {
+            more = take(&chunk);
+            const ZSTD_EndDirective mode = more ? ZSTD_e_continue : ZSTD_e_end;
+            ZSTD_inBuffer input = { chunk.constData(), more ? size_t(chunk.size()) : 0, 0 };
+            size_t remaining;
+            do
+            {
+                ZSTD_outBuffer output = { out.data(), size_t(out.size()), 0 };
+                remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+                ok = !ZSTD_isError(remaining) && put(out.constData(), qint64(output.pos));
+            } while (ok && (mode == ZSTD_e_end ? remaining != 0 : input.pos < input.size));
+        }
+        ZSTD_freeCCtx(cctx);
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+
+    if (!ok)
+        fail(m_file.error() != QFileDevice::NoError ? m_file.errorString()
+                                                    : tr("Compression failed for %1").arg(m_file.fileName()));
+}
@@ -0,0 +1,72 @@
+#ifndef COMPRESSEDDEVICE_H
+#define COMPRESSEDDEVICE_H
+
+#include <QIODevice>
+#include <QFile>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QByteArray>
+
+// A catalog file that may be gzip or zstd compressed. Reading detects the
+// format from the magic bytes, writing picks it from the suffix (.gz, .zst).
+// A worker thread inflates (or deflates) the stream in fixed-size chunks
+// through a short bounded queue, so the parser on the GUI thread sees plain
+// text while neither the whole decompressed file nor a temp copy ever
+// exists. Plain files are passed straight through to QFile.
+class CompressedDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    enum Format { Plain, Gzip, Zstd };
+
+    explicit CompressedDevice(const QString& path, QObject* parent = nullptr);
+    ~CompressedDevice() override;
+
+    static Format detect(const QString& path);
+    static Format formatForName(const QString& path);
+    static bool   isSupported(Format format);
+
+    Format format() const   { return m_format; }
+    bool   failed() const   { return m_failed; }
+
+    bool   open(OpenMode mode) override;
+    void   close() override;
+    bool   isSequential() const override { return true; }
+    bool   atEnd() const override;
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    static constexpr int ChunkBytes = 256 * 1024;
+    static constexpr int MaxQueued  = 8;
+
+    bool push(const QByteArray& chunk);
+    bool take(QByteArray* chunk);
+    void fail(const QString& error);
+    void decompress();
+    void compress();
+
+    QFile                   m_file;
+    Format                  m_format = Plain;
+    QThread*                m_worker = nullptr;
+    bool                    m_failed = false;
+
+    mutable QMutex          m_mutex;
+    mutable QWaitCondition  m_notEmpty;
+    QWaitCondition          m_notFull;
+    QQueue<QByteArray>      m_queue;
+    bool                    m_finished = false;     // producer is done
+    bool                    m_cancel   = false;     // consumer gave up
+    QString                 m_error;
+
+    mutable QByteArray      m_chunk;                // being read or filled
+    mutable int             m_chunkPos = 0;
+};
+
+#endif // COMPRESSEDDEVICE_H
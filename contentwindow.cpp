@@ -10,23 +10,50 @@ ContentWindow::ContentWindow(QWidget* parent)
 
 void ContentWindow::initialize()
 {
-    m_model = new QStandardItemModel(0, 3, this);
-    m_model->setHeaderData(0, Qt::Horizontal, tr("Name"));
-    m_model->setHeaderData(1, Qt::Horizontal, tr("Author"));
-    m_model->setHeaderData(2, Qt::Horizontal, tr("Pages"));
+    m_model = new CatalogModel(this);
 
-    m_proxy = new QSortFilterProxyModel(this);
-    m_proxy->setSourceModel(m_model);
-    m_proxy->setSortCaseSensitivity(Qt::CaseInsensitive);
+    m_authorIndex = new AuthorIndex(m_model, this);
+    m_groupModel  = new AuthorGroupModel(m_model, m_authorIndex, this);
+
+    m_proxy = new CatalogProxyModel(this);
+    m_proxy->setCatalog(m_model);
+    m_proxy->setAuthorIndex(m_authorIndex);
+
+    m_stats      = new CatalogStats(m_model, this);
+    m_statsPanel = new StatsPanel(m_model, m_stats);
+
+    m_follower = new CatalogFollower(m_model, this);
 
     m_searchEdit = new QLineEdit(this);
     m_searchEdit->setPlaceholderText(tr("Search…"));
 
-    m_proxy->setFilterKeyColumn(-1);
-    m_proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
-
-    connect(m_searchEdit, &QLineEdit::textChanged,
-            m_proxy, &QSortFilterProxyModel::setFilterFixedString);
+    m_fuzzyToggle = new QCheckBox(tr("Fuzzy"), this);
+    m_fuzzyToggle->setToolTip(tr("Tolerate typos: match Name and Author within the given number of edits"));
+    m_fuzzyDistance = new QSpinBox(this);
+    m_fuzzyDistance->setRange(0, 5);
+    m_fuzzyDistance->setValue(1);
+    m_fuzzyDistance->setEnabled(false);
+
+    auto applyFuzzy = [this]() {
+        m_fuzzyDistance->setEnabled(m_fuzzyToggle->isChecked());
+        m_proxy->setFuzzy(m_fuzzyToggle->isChecked(), m_fuzzyDistance->value());
+    };
+    connect(m_fuzzyToggle, &QCheckBox::toggled, this, applyFuzzy);
+    connect(m_fuzzyDistance, &QSpinBox::valueChanged, this, applyFuzzy);
+
+    m_searchEdit->setToolTip(tr("Plain text, or a query such as: author:tolstoy pages>300 name~\"war\""));
+    connect(m_searchEdit, &QLineEdit::textChanged, this, [this](const QString& text)
+    {
+        m_proxy->setSearchText(text);
+        const QString error = m_proxy->queryError();
+        if (error.isEmpty())
+        {
+            setModified(m_isModified);
+            return;
+        }
+        qDebug(logInfo()) << "Query not compiled, using plain search:" << error;
+        m_statusLabel->setText(error);
+    });
 
     m_table = new QTableView(this);
     m_table->setModel(m_proxy);
@@ -34,13 +61,32 @@ void ContentWindow::initialize()
     m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_table->setSelectionBehavior(QAbstractItemView::SelectItems);
     m_table->setSelectionMode(QAbstractItemView::ExtendedSelection);
-    m_table->setItemDelegateForColumn(2, new PositiveIntDelegate(this));
+    auto textDelegate  = new CachedTextDelegate(this);
+    auto pagesDelegate = new PositiveIntDelegate(this);
+    m_table->setItemDelegate(textDelegate);
+    m_table->setItemDelegateForColumn(2, pagesDelegate);
+    // Cached texts are keyed by content, so edits need no invalidation;
+    // a reload drops the texts of the old catalog.
+    connect(m_proxy, &QAbstractItemModel::modelReset, textDelegate,  &CachedTextDelegate::clearCache);
+    connect(m_proxy, &QAbstractItemModel::modelReset, pagesDelegate, &CachedTextDelegate::clearCache);
     m_table->setContextMenuPolicy(Qt::CustomContextMenu);
 
     m_listView = new QListView(this);
     m_listView->setModel(m_proxy);
     m_listView->setModelColumn(0);
 
+    m_groupView = new QTreeView(this);
+    m_groupView->setModel(m_groupModel);
+    m_groupView->setHeaderHidden(true);
+    m_groupView->setUniformRowHeights(true);
+    m_groupView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    m_sideStack = new QStackedWidget(this);
+    m_sideStack->addWidget(m_listView);
+    m_sideStack->addWidget(m_groupView);
+
+    m_groupToggle = new QCheckBox(tr("Group by author"), this);
+
     m_statusLabel = new QLabel(tr("Ready"),       this);  
 
     m_addButton   = new QPushButton(tr("Add"),    this);
@@ -64,19 +110,23 @@ void ContentWindow::initialize()
     else
         qDebug(logWarning()) << "Couldn\'t load delete-row.png.";
 
-    m_addButton->setIcon(QIcon(":/icons/add-row.png"));
-    m_addButton->setText(QString());
-    m_delButton->setIcon(QIcon(":/icons/delete-row.png"));
-    m_delButton->setText(QString());
-    
+
+    auto searchLayout = new QHBoxLayout;
+    searchLayout->addWidget(m_searchEdit, 1);
+    searchLayout->addWidget(m_fuzzyToggle);
+    searchLayout->addWidget(m_fuzzyDistance);
 
     auto tableLayout = new QVBoxLayout;
-    tableLayout->addWidget(m_searchEdit);
+    tableLayout->addLayout(searchLayout);
     tableLayout->addWidget(m_table, 1);
 
+    auto sideLayout = new QVBoxLayout;
+    sideLayout->addWidget(m_groupToggle);
+    sideLayout->addWidget(m_sideStack, 1);
+
     auto topLayout = new QHBoxLayout;
     topLayout->addLayout(tableLayout, 3);
-    topLayout->addWidget(m_listView, 2);
+    topLayout->addLayout(sideLayout, 2);
 
     auto bottomLayout = new QHBoxLayout;
     bottomLayout->addWidget(m_addButton);
@@ -92,6 +142,7 @@ void ContentWindow::initialize()
     setWindowTitle(tr("Content Window"));
 
     m_undoStack = new QUndoStack(this);
+    m_history   = new UndoHistory(m_undoStack, m_model, this);
     qDebug(logInfo()) << "Content window initialized.";
 }
 
@@ -135,6 +186,45 @@ void ContentWindow::connectSignals()
         setModified(true);
     });
 
+    connect(m_groupToggle, &QCheckBox::toggled, this, &ContentWindow::setGrouped);
+    connect(m_model, &QAbstractItemModel::modelReset, this, [this]() { m_proxy->setAuthorScope(-1); });
+    connect(m_groupView->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, [this](const QModelIndex& current, const QModelIndex&) { onGroupActivated(current); });
+
+    connect(m_follower, &CatalogFollower::merged, this, [this](int changed, int inserted, int removed, bool inPlace)
+    {
+        // Rewritten rows shift under the recorded edits, so their history goes.
+        if (inPlace)
+        {
+            m_undoStack->clear();
+            m_history->reset();
+        }
+        m_statusLabel->setText(tr("Reloaded: %1 changed, %2 added, %3 removed").arg(changed).arg(inserted).arg(removed));
+    });
+    connect(m_follower, &CatalogFollower::validated, this,
+            [this](int first, int oldRows, int newRows, const QVector<CatalogSchema::Issue>& issues)
+    {
+        // Issues of the replaced rows go, later ones move with their rows.
+        QVector<CatalogSchema::Issue> before, after;
+        for (CatalogSchema::Issue issue : m_issues)
+        {
+            if (issue.row < first)
+                before << issue;
+            else if (issue.row >= first + oldRows)
+            {
+                issue.row += newRows - oldRows;
+                after << issue;
+            }
+        }
+        m_issues = before + issues + after;
+        if (!issues.isEmpty())
+            showValidationReport();
+    });
+    connect(m_follower, &CatalogFollower::conflict, this, [this]()
+    {
+        m_statusLabel->setText(tr("File changed on disk; save or reopen to see the changes"));
+    });
+
     connect(m_table, &QWidget::customContextMenuRequested, this, [this](const QPoint& pos){
         QMenu menu;
         QAction* actCopy  = menu.addAction(tr("Copy"));
@@ -149,9 +239,31 @@ void ContentWindow::connectSignals()
     qDebug(logInfo()) << "Content window connected";
 }
 
+void ContentWindow::setGrouped(bool on)
+{
+    m_sideStack->setCurrentWidget(on ? static_cast<QWidget*>(m_groupView) : m_listView);
+    if (!on)
+        m_proxy->setAuthorScope(-1);
+    else
+        onGroupActivated(m_groupView->currentIndex());
+}
+
+// A group narrows the table to its author by id; a book also selects its row.
+void ContentWindow::onGroupActivated(const QModelIndex& index)
+{
+    m_proxy->setAuthorScope(m_groupModel->authorId(index));
+
+    const int row = m_groupModel->sourceRow(index);
+    if (row < 0) return;
+    const QModelIndex proxyIdx = m_proxy->mapFromSource(m_model->index(row, CatalogModel::NameColumn));
+    m_table->setCurrentIndex(proxyIdx);
+    m_table->scrollTo(proxyIdx);
+}
+
 void ContentWindow::setModified(bool on)
 {
     m_isModified = on;
+    m_follower->setLocalEdits(on);
     m_statusLabel->setText(on ? tr("Modified") : tr("Saved"));
 }
 
@@ -205,39 +317,357 @@ void ContentWindow::redo()
 }
 void ContentWindow::clear()
 {
-    m_model->removeRows(0, m_model->rowCount());
+    m_undoStack->clear();
+    m_history->reset();
+    m_model->beginLoad();
+    m_model->endLoad();
     setModified(false);
 }
 
-void ContentWindow::write(QTextStream& out)
+void ContentWindow::write(QIODevice& out)
 {
-    const int rows = m_model->rowCount();
-    const int cols = m_model->columnCount();
+    write(out, m_model->snapshot());
+}
 
-    for (int r = 0; r < rows; ++r) 
-    {
-        QStringList rowText;
-        for (int c = 0; c < cols; ++c) {
-            QModelIndex idx = m_model->index(r, c);
-            rowText << idx.data(Qt::EditRole).toString();
-        }
-        out << rowText.join('\t') << '\n';
-    }
+// Reads nothing but the snapshot, so saving can run on a worker thread.
+bool ContentWindow::write(QIODevice& out, const CatalogStore::Snapshot& rows)
+{
+    CatalogWriter writer(&out);
+    for (int b = 0; b < rows.blockCount(); ++b)
+        for (const CatalogStore::Row& row : rows.block(b))
+            writer.writeRow(row.name, row.author, row.pages);
+    return writer.flush();
 }
 
-void ContentWindow::read(QTextStream& in)
+void ContentWindow::read(QIODevice& in)
 {
-    m_model->removeRows(0, m_model->rowCount());
-    while (!in.atEnd()) 
+    QElapsedTimer timer;
+    timer.start();
+    CatalogReader reader(&in);
+
+    // Rows are built as lines arrive. Each batch is validated on the thread
+    // pool while the next one is read, so at most two batches of text are
+    // held at a time.
+    QFuture<QVector<CatalogSchema::Issue>> validation;
+    QStringList lines;
+    QVector<int> lineNumbers;
+    int rows = 0;
+    m_issues.clear();
+    const auto validate = [&]() {
+        if (validation.isValid())
+            m_issues += validation.result();
+        validation = CatalogSchema::validateLines(lines, lineNumbers, rows - int(lines.size()));
+        lines = QStringList();
+        lineNumbers = QVector<int>();
+    };
+
+    m_model->beginLoad();
+    QString line;
+    for (int lineNo = 1; reader.readLine(&line); ++lineNo)
     {
-        QString line = in.readLine();
         if (line.isEmpty()) continue;
         QStringList fields = line.split('\t');
-        int newRow = m_model->rowCount();
-        m_model->insertRow(newRow);
-        for (int c = 0; c < fields.size() && c < m_model->columnCount(); ++c) {
-            m_model->setData(m_model->index(newRow, c), fields[c]);
-        }
+        while (fields.size() < CatalogModel::ColumnCount)
+            fields << QString();
+        m_model->appendRow(m_model->makeRow(fields[CatalogModel::NameColumn],
+                                            fields[CatalogModel::AuthorColumn],
+                                            fields[CatalogModel::PagesColumn]));
+        lines << line;
+        lineNumbers << lineNo;
+        if (++rows % ReadBatchRows == 0)
+            validate();
+    }
+    m_model->endLoad();
+    const qint64 built = timer.elapsed();
+    if (!lines.isEmpty())
+        validate();
+    if (validation.isValid())
+        m_issues += validation.result();
+
+    qDebug(logInfo()) << "Read" << reader.bytesRead() << "bytes in" << built << "ms.";
+    if (reader.invalidLines() > 0)
+        qDebug(logWarning()) << reader.invalidLines() << "lines are not valid UTF-8;"
+                             << "bad bytes were replaced.";
+    qDebug(logInfo()) << "Loaded" << rows << "rows in" << built << "ms, validated in"
+                      << timer.elapsed() << "ms," << m_issues.size() << "problems.";
+
+    const AuthorPool::Stats st = m_model->authors().stats();
+    qDebug(logInfo()) << "Author pool:" << st.live << "distinct authors for"
+                      << st.references << "cells," << st.savedBytes << "bytes shared.";
+    setModified(false);
+
+    if (!m_issues.isEmpty())
+        showValidationReport();
+}
+
+void ContentWindow::showValidationReport()
+{
+    if (!m_validationDialog)
+    {
+        m_validationDialog = new ValidationDialog(this);
+        connect(m_validationDialog, &ValidationDialog::jumpRequested, this, &ContentWindow::jumpTo);
+        connect(m_validationDialog, &ValidationDialog::fixRequested,  this, &ContentWindow::fixInvalidRows);
+        connect(m_validationDialog, &ValidationDialog::revalidateRequested, this, [this]() {
+            m_issues = CatalogSchema::validateModel(m_model);
+            m_validationDialog->setIssues(m_issues);
+        });
+    }
+    m_validationDialog->setIssues(m_issues);
+    m_validationDialog->show();
+    m_validationDialog->raise();
+}
+
+// Re-checks the current rows and repairs every fixable cell as one undo step.
+void ContentWindow::fixInvalidRows()
+{
+    m_issues = CatalogSchema::validateModel(m_model);
+
+    QVector<CatalogModel::CellChange> changes;
+    for (const CatalogSchema::Issue& issue : m_issues)
+    {
+        const QString fixed = CatalogSchema::fixedValue(m_model, issue);
+        if (fixed.isNull()) continue;
+        const QStandardItem* it = m_model->item(issue.row, issue.column);
+        changes.append({ issue.row, issue.column, it ? it->text() : QString(), fixed });
+    }
+
+    if (!changes.isEmpty())
+    {
+        qDebug(logInfo()) << changes.size() << "invalid cells fixed.";
+        m_undoStack->push(new BatchEditCommand(m_model, changes, tr("Fix invalid rows")));
+        setModified(true);
+    }
+
+    m_issues = CatalogSchema::validateModel(m_model);
+    if (m_validationDialog)
+        m_validationDialog->setIssues(m_issues);
+}
+
+void ContentWindow::jumpTo(int row, int column)
+{
+    QModelIndex idx = m_proxy->mapFromSource(m_model->index(row, column));
+    if (!idx.isValid())
+    {
+        // The row is filtered out; drop the filters so it can be shown.
+        m_searchEdit->clear();
+        m_groupToggle->setChecked(false);
+        idx = m_proxy->mapFromSource(m_model->index(row, column));
+    }
+    m_table->setCurrentIndex(idx);
+    m_table->scrollTo(idx);
+    m_table->setFocus();
+}
+
+void ContentWindow::showDuplicates()
+{
+    if (!m_duplicatesDialog)
+    {
+        m_duplicatesDialog = new DuplicatesDialog(this);
+        connect(m_duplicatesDialog, &DuplicatesDialog::jumpRequested, this, &ContentWindow::jumpTo);
+        connect(m_duplicatesDialog, &DuplicatesDialog::findRequested, this, [this]()
+        {
+            m_duplicatesRetries = 0;
+            findDuplicates();
+        });
+        connect(&m_duplicatesWatcher, &QFutureWatcherBase::finished, this, [this]()
+        {
+            // Row numbers from an older version may point at other books.
+            // While edits keep arriving the search is retried a few times,
+            // spaced out, and then left to the user.
+            if (m_model->version() != m_duplicatesVersion)
+            {
+                m_duplicates.clear();
+                if (++m_duplicatesRetries > DuplicateRetries)
+                {
+                    m_duplicatesDialog->setStatus(tr("The catalog kept changing during the search. Press Find to try again."));
+                    return;
+                }
+                QTimer::singleShot(DuplicateRetryDelay, this, &ContentWindow::findDuplicates);
+                return;
+            }
+            m_duplicatesRetries = 0;
+            m_duplicates = m_duplicatesWatcher.result();
+            m_duplicatesDialog->setGroups(m_model, m_duplicates);
+        });
+        connect(m_duplicatesDialog, &DuplicatesDialog::removeRequested, this, [this]()
+        {
+            if (m_model->version() != m_duplicatesVersion)
+            {
+                m_duplicatesRetries = 0;
+                findDuplicates();
+                return;
+            }
+            QVector<int> rows;
+            for (const QVector<int>& group : m_duplicates)
+                rows += group.mid(1);
+            if (rows.isEmpty()) return;
+            std::sort(rows.begin(), rows.end());
+
+            qDebug(logInfo()) << rows.size() << "duplicate rows removed.";
+            m_undoStack->push(new RemoveRowsCommand(m_model, rows));
+            setModified(true);
+            m_duplicates.clear();
+            m_duplicatesDialog->setGroups(m_model, m_duplicates);
+        });
+    }
+    m_duplicatesDialog->show();
+    m_duplicatesDialog->raise();
+}
+
+// The search reads a snapshot on the thread pool while editing goes on.
+void ContentWindow::findDuplicates()
+{
+    m_duplicatesDialog->setStatus(tr("Searching…"));
+    if (m_duplicatesWatcher.isRunning()) return;
+    DuplicateFinder::Options options;
+    options.nearDuplicates = m_duplicatesDialog->nearDuplicates();
+    const CatalogStore::Snapshot rows = m_model->snapshot();
+    m_duplicatesVersion = rows.version();
+    m_duplicatesWatcher.setFuture(QtConcurrent::run([rows, options]() {
+        QElapsedTimer timer;
+        timer.start();
+        const QVector<QVector<int>> groups = DuplicateFinder::find(rows, options);
+        qDebug(logInfo()) << "Duplicate search found" << groups.size() << "groups in" << timer.elapsed() << "ms.";
+        return groups;
+    }));
+}
+
+void ContentWindow::showFindReplace()
+{
+    if (!m_findReplaceDialog)
+    {
+        m_findReplaceDialog = new FindReplaceDialog(this);
+        connect(m_findReplaceDialog, &FindReplaceDialog::replaceAllRequested, this, [this]()
+        {
+            const FindReplace::Options options = m_findReplaceDialog->options();
+            QElapsedTimer timer;
+            timer.start();
+            int skipped = 0;
+            QString error;
+            const QVector<CatalogModel::CellChange> changes = FindReplace::collect(m_model, options, &skipped, &error);
+            if (!error.isEmpty())
+            {
+                m_findReplaceDialog->setResult(error);
+                return;
+            }
+            const qint64 scanned = timer.elapsed();
+
+            if (!changes.isEmpty())
+            {
+                m_undoStack->push(new BatchEditCommand(m_model, changes, tr("Replace \"%1\"").arg(options.find)));
+                setModified(true);
+            }
+            qDebug(logInfo()) << "Replaced" << changes.size() << "cells: scan" << scanned
+                              << "ms, total" << timer.elapsed() << "ms.";
+
+            QString result = tr("%n cell(s) changed.", nullptr, changes.size());
+            if (skipped > 0)
+                result += ' ' + tr("%n Pages cell(s) skipped: the result would not be a valid page count.", nullptr, skipped);
+            m_findReplaceDialog->setResult(result);
+        });
+    }
+    m_findReplaceDialog->show();
+    m_findReplaceDialog->raise();
+}
+
+bool ContentWindow::loadHistory(const QString& path)
+{
+    return m_history->load(path);
+}
+
+UndoHistory::SavePlan ContentWindow::prepareHistory(const QString& path) const
+{
+    return m_history->prepareSave(path);
+}
+
+void ContentWindow::finishHistory(const UndoHistory::SavePlan& plan, bool current)
+{
+    m_history->finishSave(plan, current);
+}
+
+void ContentWindow::follow(const QString& path)
+{
+    if (path.isEmpty())
+        m_follower->stop();
+    else
+        m_follower->follow(path);
+}
+
+bool ContentWindow::setServerEnabled(bool on)
+{
+    if (!on)
+    {
+        if (m_server)
+            m_server->close();
+        return true;
     }
+    if (!m_server)
+    {
+        m_server = new CatalogServer(m_model, this);
+        connect(m_server, &CatalogServer::rowsAppended, this, [this](int count)
+        {
+            setModified(true);
+            m_statusLabel->setText(tr("%n row(s) added by another program", nullptr, count));
+        });
+    }
+    return m_server->isListening() || m_server->listen(QString::fromLatin1(CatalogProtocol::DefaultServerName));
+}
+
+// Loads the cached copy of source if it is still current; the caller falls
+// back to parsing the file otherwise.
+bool ContentWindow::restoreSnapshot(const QString& source)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (!SessionSnapshot::load(m_model, source, SessionSnapshot::defaultPath()))
+        return false;
+    const qint64 loaded = timer.elapsed();
+
+    // The snapshot may predate a change to the rules, so it is held to the
+    // same checks as the file.
+    m_issues = CatalogSchema::validateModel(m_model);
     setModified(false);
-}
\ No newline at end of file
+    qDebug(logInfo()) << "Restored" << m_model->rowCount() << "rows from the session snapshot in" << loaded
+                      << "ms, validated in" << timer.elapsed() - loaded << "ms," << m_issues.size() << "problems.";
+    if (!m_issues.isEmpty())
+        showValidationReport();
+    return true;
+}
+
+void ContentWindow::saveSnapshot(const QString& source) const
+{
+    const QString path = SessionSnapshot::defaultPath();
+    if (SessionSnapshot::isFresh(source, path))
+        return;
+    QElapsedTimer timer;
+    timer.start();
+    if (SessionSnapshot::save(m_model, source, path))
+        qDebug(logInfo()) << "Session snapshot written in" << timer.elapsed() << "ms.";
+    else
+        qDebug(logWarning()) << "Couldn't write the session snapshot" << path;
+}
+
+void ContentWindow::saveViewState(QSettings& settings) const
+{
+    settings.setValue("sortColumn",    m_table->horizontalHeader()->sortIndicatorSection());
+    settings.setValue("sortOrder",     int(m_table->horizontalHeader()->sortIndicatorOrder()));
+    settings.setValue("filter",        m_searchEdit->text());
+    settings.setValue("fuzzy",         m_fuzzyToggle->isChecked());
+    settings.setValue("fuzzyDistance", m_fuzzyDistance->value());
+    settings.setValue("scroll",        m_table->verticalScrollBar()->value());
+}
+
+void ContentWindow::restoreViewState(const QSettings& settings)
+{
+    m_fuzzyDistance->setValue(settings.value("fuzzyDistance", 1).toInt());
+    m_fuzzyToggle->setChecked(settings.value("fuzzy", false).toBool());
+    m_searchEdit->setText(settings.value("filter").toString());
+
+    const int column = settings.value("sortColumn", -1).toInt();
+    if (column >= 0 && column < CatalogModel::ColumnCount)
+        m_table->sortByColumn(column, Qt::SortOrder(settings.value("sortOrder").toInt()));
+
+    // The scroll range is only known once the view has laid out the rows.
+    const int scroll = settings.value("scroll", 0).toInt();
+    QTimer::singleShot(0, this, [this, scroll]() { m_table->verticalScrollBar()->setValue(scroll); });
+}
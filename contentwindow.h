@@ -19,9 +19,36 @@
 #include <QMenu>
 #include <QIcon>
 #include <QSize>
+#include <QTreeView>
+#include <QStackedWidget>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QSettings>
+#include <QScrollBar>
+#include <QTimer>
 
 #include "positiveintdelegate.h"
+#include "catalogmodel.h"
+#include "catalogproxymodel.h"
+#include "catalogstats.h"
+#include "statspanel.h"
+#include "authorindex.h"
+#include "authorgroupmodel.h"
+#include "catalogschema.h"
+#include "validationdialog.h"
+#include "duplicatefinder.h"
+#include "duplicatesdialog.h"
+#include "findreplacedialog.h"
+#include "catalogfollower.h"
+#include "catalogserver.h"
+#include "sessionsnapshot.h"
 #include "celleditcommand.h"
+#include "undohistory.h"
+#include "catalogio.h"
 #include "loghandler.h"
 #include "addremoverows.h"
 
@@ -44,23 +71,78 @@ public:
     void undo();
     void redo();
     void clear();
-    void write(QTextStream& out);
-    void read(QTextStream& in);
+    void write(QIODevice& out);
+    void read(QIODevice& in);
+
+    StatsPanel* statsPanel() const { return m_statsPanel; }
+
+    void showValidationReport();
+    void fixInvalidRows();
+    void jumpTo(int row, int column);
+    void showDuplicates();
+    void showFindReplace();
+
+    // Follows external changes to the file at path; an empty path stops.
+    void follow(const QString& path);
+
+    // Serves the catalog to other programs over a local socket.
+    bool setServerEnabled(bool on);
+
+    // Undo history kept beside the catalog file.
+    bool loadHistory(const QString& path);
+    UndoHistory::SavePlan prepareHistory(const QString& path) const;
+    void finishHistory(const UndoHistory::SavePlan& plan, bool current);
+
+    bool restoreSnapshot(const QString& source);
+    void saveSnapshot(const QString& source) const;
+    void saveViewState(QSettings& settings) const;
+    void restoreViewState(const QSettings& settings);
+
+    CatalogStore::Snapshot snapshot() const   { return m_model->snapshot(); }
+    quint64 version() const                   { return m_model->version(); }
+    static bool write(QIODevice& out, const CatalogStore::Snapshot& rows);
 
 private:
+    static constexpr int DuplicateRetries     = 3;
+    static constexpr int DuplicateRetryDelay  = 500;    // ms
+    static constexpr int ReadBatchRows        = 65536;
+
     void initialize();
     void connectSignals();
+    void setGrouped(bool on);
+    void onGroupActivated(const QModelIndex& index);
+    void findDuplicates();
 
     QLineEdit*              m_searchEdit = nullptr;
+    QCheckBox*              m_fuzzyToggle   = nullptr;
+    QSpinBox*               m_fuzzyDistance = nullptr;
     bool                    m_isModified  = false;
     bool                    m_blockUndo   = false;
     QString                 m_lastOldValue;
-    QStandardItemModel*     m_model       = nullptr;
-    QSortFilterProxyModel*  m_proxy       = nullptr;
+    CatalogModel*           m_model       = nullptr;
+    CatalogProxyModel*      m_proxy       = nullptr;
+    CatalogStats*           m_stats       = nullptr;
+    StatsPanel*             m_statsPanel  = nullptr;
+    AuthorIndex*            m_authorIndex = nullptr;
+    AuthorGroupModel*       m_groupModel  = nullptr;
     QUndoStack*             m_undoStack   = nullptr;
+    UndoHistory*            m_history     = nullptr;
+    ValidationDialog*       m_validationDialog = nullptr;
+    QVector<CatalogSchema::Issue> m_issues;
+    DuplicatesDialog*       m_duplicatesDialog = nullptr;
+    QVector<QVector<int>>   m_duplicates;
+    quint64                 m_duplicatesVersion = 0;
+    QFutureWatcher<QVector<QVector<int>>> m_duplicatesWatcher;
+    int                     m_duplicatesRetries = 0;
+    FindReplaceDialog*      m_findReplaceDialog = nullptr;
+    CatalogFollower*        m_follower    = nullptr;
+    CatalogServer*          m_server      = nullptr;
 
     QTableView*             m_table       = nullptr;
     QListView*              m_listView    = nullptr;
+    QTreeView*              m_groupView   = nullptr;
+    QStackedWidget*         m_sideStack   = nullptr;
+    QCheckBox*              m_groupToggle = nullptr;
     QPushButton*            m_addButton   = nullptr;
     QPushButton*            m_delButton   = nullptr;
     QLabel*                 m_statusLabel = nullptr;
@@ -0,0 +1,177 @@
+#include "duplicatefinder.h"
+
+#include <QtConcurrent>
+#include <QHash>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+const int Hashes    = 16;
+const int Bands     = 4;
+const int BandRows  = Hashes / Bands;
+
+quint64 mix(quint64 x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+class UnionFind
+{
+public:
+    explicit UnionFind(int n) : m_parent(n)
+    {
+        for (int i = 0; i < n; ++i) m_parent[i] = i;
+    }
+    int find(int x)
+    {
+        while (m_parent[x] != x)
+        {
+            m_parent[x] = m_parent[m_parent[x]];
+            x = m_parent[x];
+        }
+        return x;
+    }
+    // The lower row always becomes the root, so it is the one that is kept.
+    void unite(int a, int b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (a < b) m_parent[b] = a;
+        else       m_parent[a] = b;
+    }
+
+private:
+    QVector<int> m_parent;
+};
+
+// Runs fn(index, row) over the snapshot a block at a time on the global
+// thread pool.
+template <typename Fn>
+void forRows(const CatalogStore::Snapshot& snapshot, Fn fn)
+{
+    QVector<int> blocks(snapshot.blockCount());
+    std::iota(blocks.begin(), blocks.end(), 0);
+    QtConcurrent::blockingMap(blocks, [&](int b) {
+        const QVector<CatalogStore::Row>& block = snapshot.block(b);
+        const int start = snapshot.blockStart(b);
+        for (int i = 0; i < block.size(); ++i)
+            fn(start + i, block.at(i));
+    });
+}
+
+} // namespace
+
+QString DuplicateFinder::normalize(const QString& text)
+{
+    return text.simplified().toCaseFolded();
+}
+
+QVector<QVector<int>> DuplicateFinder::find(const CatalogStore::Snapshot& snapshot, const Options& options)
+{
+    const int rows = snapshot.rowCount();
+    QVector<quint64> keys(rows);
+    QVector<quint64> authorKeys(rows);
+    quint64* keyOut    = keys.data();
+    quint64* authorOut = authorKeys.data();
+
+    forRows(snapshot, [&](int r, const CatalogStore::Row& row) {
+        const QString name   = normalize(row.name);
+        const QString author = normalize(row.author);
+        authorOut[r] = qHash(author, 0x5bd1e995U);
+        keyOut[r]    = mix(qHash(name, 0x1b873593U) ^ mix(authorOut[r]));
+    });
+
+    UnionFind groups(rows);
+    const auto sameBook = [&snapshot](int a, int b) {
+        const CatalogStore::Row& ra = snapshot.row(a);
+        const CatalogStore::Row& rb = snapshot.row(b);
+        return normalize(ra.name) == normalize(rb.name) && normalize(ra.author) == normalize(rb.author);
+    };
+
+    QHash<quint64, int> firstWithKey;
+    firstWithKey.reserve(rows);
+    for (int r = 0; r < rows; ++r)
+    {
+        auto it = firstWithKey.constFind(keys[r]);
+        if (it == firstWithKey.constEnd())
+            firstWithKey.insert(keys[r], r);
+        else if (sameBook(it.value(), r))   // rule out hash collisions
+            groups.unite(it.value(), r);
+    }
+
+    if (options.nearDuplicates)
+    {
+        QVector<quint32> signatures(rows * Hashes);
+        quint32* sigOut = signatures.data();
+        forRows(snapshot, [&](int r, const CatalogStore::Row& row) {
+            quint32* sig = sigOut + r * Hashes;
+            std::fill(sig, sig + Hashes, ~quint32(0));
+            const QString name = normalize(row.name);
+            const int shingles = std::max(1, int(name.size()) - 2);
+            for (int i = 0; i < shingles; ++i)
+            {
+                const quint64 h = qHash(QStringView(name).mid(i, 3));
+                for (int k = 0; k < Hashes; ++k)
+                    sig[k] = std::min(sig[k], quint32(mix(h + quint64(k) * 0x632be59bd9b4e019ULL)));
+            }
+        });
+
+        const auto similar = [&](int a, int b) {
+            const quint32* sa = signatures.constData() + a * Hashes;
+            const quint32* sb = signatures.constData() + b * Hashes;
+            int same = 0;
+            for (int k = 0; k < Hashes; ++k)
+                same += sa[k] == sb[k];
+            return same >= options.similarity * Hashes;
+        };
+
+        // Rows sharing an author and one whole band of their signature are
+        // candidates; the full signature then estimates the similarity.
+        for (int band = 0; band < Bands; ++band)
+        {
+            QHash<quint64, int> bucket;
+            bucket.reserve(rows);
+            for (int r = 0; r < rows; ++r)
+            {
+                quint64 key = mix(authorKeys[r] + quint64(band));
+                const quint32* sig = signatures.constData() + r * Hashes + band * BandRows;
+                for (int i = 0; i < BandRows; ++i)
+                    key = mix(key ^ sig[i]);
+
+                auto it = bucket.constFind(key);
+                if (it == bucket.constEnd())
+                    bucket.insert(key, r);
+                else if (similar(it.value(), r))
+                    groups.unite(it.value(), r);
+            }
+        }
+    }
+
+    // Roots are the lowest row of their set and rows are visited in order,
+    // so every group comes out sorted.
+    QVector<QVector<int>> result;
+    QHash<int, int> groupOf;
+    for (int r = 0; r < rows; ++r)
+    {
+        const int root = groups.find(r);
+        if (root == r) continue;
+        auto it = groupOf.constFind(root);
+        if (it == groupOf.constEnd())
+        {
+            groupOf.insert(root, result.size());
+            result.append(QVector<int>{ root, r });
+        }
+        else
+        {
+            result[it.value()].append(r);
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const QVector<int>& a, const QVector<int>& b) { return a.first() < b.first(); });
+    return result;
+}
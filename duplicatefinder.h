@@ -0,0 +1,29 @@
+#ifndef DUPLICATEFINDER_H
+#define DUPLICATEFINDER_H
+
+#include <QVector>
+#include <QString>
+
+#include "catalogstore.h"
+
+// Groups rows whose Name and Author are equal once case-folded and with
+// whitespace collapsed. With near-duplicates enabled, titles by the same
+// author are also grouped when their character-trigram sets are similar,
+// found through MinHash signatures bucketed by LSH bands.
+class DuplicateFinder
+{
+public:
+    struct Options
+    {
+        bool   nearDuplicates = false;
+        double similarity     = 0.8;    // estimated Jaccard similarity of titles
+    };
+
+    // Each group lists source rows in ascending order; groups are ordered by
+    // their first row. Safe to run on a worker thread.
+    static QVector<QVector<int>> find(const CatalogStore::Snapshot& snapshot, const Options& options);
+
+    static QString normalize(const QString& text);
+};
+
+#endif // DUPLICATEFINDER_H
@@ -0,0 +1,86 @@
+#include "duplicatesdialog.h"
+
+DuplicatesDialog::DuplicatesDialog(QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Duplicate books"));
+    resize(560, 400);
+
+    m_near = new QCheckBox(tr("Include similar titles by the same author"), this);
+    QPushButton* find = new QPushButton(tr("Find"), this);
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setColumnCount(CatalogModel::ColumnCount);
+    m_tree->setHeaderLabels({ CatalogModel::columnName(CatalogModel::NameColumn),
+                              CatalogModel::columnName(CatalogModel::AuthorColumn),
+                              CatalogModel::columnName(CatalogModel::PagesColumn) });
+    m_tree->setUniformRowHeights(true);
+
+    m_summary = new QLabel(this);
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_remove = buttons->addButton(tr("Keep first, remove the rest"), QDialogButtonBox::ActionRole);
+    m_remove->setEnabled(false);
+
+    auto top = new QHBoxLayout;
+    top->addWidget(m_near, 1);
+    top->addWidget(find);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(top);
+    layout->addWidget(m_summary);
+    layout->addWidget(m_tree, 1);
+    layout->addWidget(buttons);
+    setLayout(layout);
+
+    connect(find,     &QPushButton::clicked, this, &DuplicatesDialog::findRequested);
+    connect(m_remove, &QPushButton::clicked, this, &DuplicatesDialog::removeRequested);
+    connect(buttons,  &QDialogButtonBox::rejected, this, &QDialog::close);
+    connect(m_tree, &QTreeWidget::itemActivated, this, [this](QTreeWidgetItem* item, int column) {
+        const QVariant row = item->data(0, Qt::UserRole);
+        if (row.isValid())
+            emit jumpRequested(row.toInt(), column);
+    });
+}
+
+void DuplicatesDialog::setGroups(const CatalogModel* model, const QVector<QVector<int>>& groups)
+{
+    m_tree->clear();
+
+    int duplicates = 0;
+    QList<QTreeWidgetItem*> top;
+    for (const QVector<int>& group : groups)
+    {
+        duplicates += group.size() - 1;
+        if (top.size() >= MaxShownGroups) continue;
+
+        auto groupItem = new QTreeWidgetItem;
+        for (int row : group)
+        {
+            auto child = new QTreeWidgetItem(groupItem);
+            for (int c = 0; c < CatalogModel::ColumnCount; ++c)
+            {
+                const QStandardItem* it = model->item(row, c);
+                child->setText(c, it ? it->text() : QString());
+            }
+            child->setData(0, Qt::UserRole, row);
+        }
+        groupItem->setText(0, tr("%1 (%2 copies)").arg(groupItem->child(0)->text(0)).arg(group.size()));
+        groupItem->setText(1, groupItem->child(0)->text(1));
+        top.append(groupItem);
+    }
+    m_tree->addTopLevelItems(top);
+
+    if (groups.isEmpty())
+        m_summary->setText(tr("No duplicates found."));
+    else
+        m_summary->setText(tr("%1 groups, %2 rows to remove.").arg(groups.size()).arg(duplicates)
+                           + (groups.size() > MaxShownGroups ? tr(" Showing the first %1 groups.").arg(MaxShownGroups) : QString()));
+    m_remove->setEnabled(!groups.isEmpty());
+}
+
+void DuplicatesDialog::setStatus(const QString& text)
+{
+    m_summary->setText(text);
+    m_remove->setEnabled(false);
+}
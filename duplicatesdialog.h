@@ -0,0 +1,41 @@
+#ifndef DUPLICATESDIALOG_H
+#define DUPLICATESDIALOG_H
+
+#include <QDialog>
+#include <QTreeWidget>
+#include <QCheckBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+#include "catalogmodel.h"
+
+class DuplicatesDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DuplicatesDialog(QWidget* parent = nullptr);
+
+    void setGroups(const CatalogModel* model, const QVector<QVector<int>>& groups);
+    // Shown while no current results exist; removal waits for new ones.
+    void setStatus(const QString& text);
+    bool nearDuplicates() const { return m_near->isChecked(); }
+
+signals:
+    void findRequested();
+    void removeRequested();
+    void jumpRequested(int row, int column);
+
+private:
+    static constexpr int MaxShownGroups = 5000;
+
+    QCheckBox*      m_near    = nullptr;
+    QTreeWidget*    m_tree    = nullptr;
+    QLabel*         m_summary = nullptr;
+    QPushButton*    m_remove  = nullptr;
+};
+
+#endif // DUPLICATESDIALOG_H
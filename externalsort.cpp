@@ -0,0 +1,409 @@
+#include "externalsort.h"
+#include "compresseddevice.h"
+
+#include <QTemporaryFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QObject>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace {
+
+// What one open input may hold in buffers: QFile's read buffer for plain
+// files, the decoder's chunk queue for compressed ones.
+const qint64 InputBytes = qint64(4) << 20;
+
+typedef std::vector<std::unique_ptr<QIODevice>> Sources;
+
+struct Record
+{
+    QByteArray line;
+    QString    text;
+    qint64     number = 0;
+};
+
+class Key
+{
+public:
+    explicit Key(const ExternalSort::Options& options)
+        : m_column(options.column)
+        , m_numeric(options.column == CatalogModel::PagesColumn)
+        , m_descending(options.descending)
+    {
+    }
+
+    Record make(const QByteArray& line) const
+    {
+        Record r;
+        r.line = line;
+        int from = 0;
+        for (int c = 0; c < m_column && from >= 0; ++c)
+        {
+            from = line.indexOf('\t', from);
+            if (from >= 0) ++from;
+        }
+        QByteArray field;
+        if (from >= 0)
+        {
+            const int to = line.indexOf('\t', from);
+            field = line.mid(from, to < 0 ? -1 : to - from);
+        }
+
+        if (m_numeric)
+        {
+            // Rows without a valid page count go last.
+            bool ok = false;
+            r.number = field.trimmed().toLongLong(&ok);
+            if (!ok) r.number = std::numeric_limits<qint64>::max();
+        }
+        else
+            r.text = QString::fromUtf8(field);
+        return r;
+    }
+
+    // The column alone; rows that tie on it may come in any order.
+    int compareColumn(const Record& a, const Record& b) const
+    {
+        const int c = m_numeric ? (a.number < b.number ? -1 : a.number > b.number ? 1 : 0)
+                                : QString::compare(a.text, b.text);
+        return m_descending ? -c : c;
+    }
+
+    // Ties are broken on the whole line, so equal lines end up adjacent.
+    int compare(const Record& a, const Record& b) const
+    {
+        const int c = compareColumn(a, b);
+        if (c != 0) return c;
+        const int l = a.line.compare(b.line);
+        return m_descending ? -l : l;
+    }
+
+    int column() const { return m_column; }
+
+    static qint64 cost(const Record& r)
+    {
+        return qint64(sizeof(Record)) + r.line.size() + 2 * r.text.size() + 64;
+    }
+
+private:
+    int  m_column;
+    bool m_numeric;
+    bool m_descending;
+};
+
+class Writer
+{
+public:
+    Writer(QIODevice* out, bool unique) : m_out(out), m_unique(unique) {}
+
+    bool put(const QByteArray& line)
+    {
+        if (m_unique && m_rows > 0 && line == m_last)
+        {
+            ++m_dropped;
+            return true;
+        }
+        m_last = line;
+        ++m_rows;
+        return m_out->write(line) == line.size() && m_out->putChar('\n');
+    }
+
+    qint64 rows() const     { return m_rows; }
+    qint64 dropped() const  { return m_dropped; }
+
+private:
+    QIODevice*  m_out;
+    bool        m_unique;
+    QByteArray  m_last;
+    qint64      m_rows    = 0;
+    qint64      m_dropped = 0;
+};
+
+// Reads the next non-empty line, without its line break.
+bool readLine(QIODevice* in, QByteArray* line)
+{
+    while (!in->atEnd())
+    {
+        QByteArray l = in->readLine();
+        while (l.endsWith('\n') || l.endsWith('\r'))
+            l.chop(1);
+        if (!l.isEmpty())
+        {
+            *line = l;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool setError(QString* error, const QString& text)
+{
+    if (error) *error = text;
+    return false;
+}
+
+// A finished run. It is kept closed until its group is merged, so waiting
+// runs hold neither a descriptor nor a buffer, and is deleted with the object.
+class RunFile : public QFile
+{
+public:
+    explicit RunFile(const QString& name) : QFile(name) {}
+    ~RunFile() override { remove(); }
+};
+
+std::unique_ptr<QTemporaryFile> makeRun(QString* error)
+{
+    auto file = std::make_unique<QTemporaryFile>(QDir::temp().filePath("laba2-run-XXXXXX"));
+    if (!file->open())
+    {
+        setError(error, QObject::tr("Cannot create a temporary file: %1").arg(file->errorString()));
+        return nullptr;
+    }
+    return file;
+}
+
+// QTemporaryFile keeps its descriptor even after close(), so the written
+// run is handed over to a RunFile by name.
+std::unique_ptr<QIODevice> closeRun(std::unique_ptr<QTemporaryFile> file, QString* error)
+{
+    if (!file->flush())
+    {
+        setError(error, file->errorString());
+        return nullptr;
+    }
+    file->setAutoRemove(false);
+    const QString name = file->fileName();
+    file.reset();
+    return std::make_unique<RunFile>(name);
+}
+
+bool mergeInto(const Sources& sources, const QStringList& names, Writer& out, const Key& key,
+               bool checkOrder, QString* error)
+{
+    std::vector<Record> heads(sources.size());
+    const auto greater = [&](size_t a, size_t b) {
+        const int c = key.compare(heads[a], heads[b]);
+        return c != 0 ? c > 0 : a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+
+    // Inputs are opened only when their group is merged, so at most fanIn
+    // of them hold buffers at any time.
+    QByteArray line;
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        QIODevice* in = sources[i].get();
+        if (!in->isOpen() && !in->open(QIODevice::ReadOnly))
+            return setError(error, QObject::tr("Cannot open %1: %2").arg(names.value(int(i)), in->errorString()));
+        if (readLine(in, &line))
+        {
+            heads[i] = key.make(line);
+            heap.push(i);
+        }
+    }
+
+    while (!heap.empty())
+    {
+        const size_t i = heap.top();
+        heap.pop();
+        if (!out.put(heads[i].line))
+            return setError(error, QObject::tr("Write failed"));
+
+        if (readLine(sources[i].get(), &line))
+        {
+            Record next = key.make(line);
+            if (checkOrder && key.compareColumn(heads[i], next) > 0)
+                return setError(error, QObject::tr("%1 is not sorted by %2; sort it instead of merging")
+                                           .arg(names.value(int(i)), CatalogModel::columnName(key.column())));
+            heads[i] = std::move(next);
+            heap.push(i);
+        }
+    }
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        sources[i]->close();
+        auto in = qobject_cast<CompressedDevice*>(sources[i].get());
+        if (in && in->failed())
+            return setError(error, QObject::tr("Cannot read %1: %2").arg(names.value(int(i)), in->errorString()));
+    }
+    return true;
+}
+
+// Merges groups of fanIn sources into temp runs until one final merge is left.
+bool reduce(Sources& sources, QStringList& names, const Key& key, const ExternalSort::Options& options,
+            int fanIn, bool checkOrder, ExternalSort::Result& result, QString* error)
+{
+    while (int(sources.size()) > fanIn)
+    {
+        Sources next;
+        for (size_t first = 0; first < sources.size(); first += fanIn)
+        {
+            const size_t last = std::min(sources.size(), first + fanIn);
+            Sources group;
+            QStringList groupNames;
+            for (size_t i = first; i < last; ++i)
+            {
+                group.push_back(std::move(sources[i]));
+                groupNames << names.value(int(i));
+            }
+
+            std::unique_ptr<QTemporaryFile> run = makeRun(error);
+            if (!run) return false;
+            Writer w(run.get(), options.unique);
+            if (!mergeInto(group, groupNames, w, key, checkOrder, error))
+                return false;
+            std::unique_ptr<QIODevice> closed = closeRun(std::move(run), error);
+            if (!closed) return false;
+            result.dropped += w.dropped();
+            next.push_back(std::move(closed));
+        }
+        sources = std::move(next);
+        names   = QStringList();
+        checkOrder = false;
+        ++result.passes;
+    }
+    return true;
+}
+
+bool finish(Sources& sources, const QStringList& names, const QString& output, const Key& key,
+            const ExternalSort::Options& options, bool checkOrder, ExternalSort::Result& result, QString* error)
+{
+    CompressedDevice out(output);
+    if (!out.open(QIODevice::WriteOnly))
+        return setError(error, QObject::tr("Cannot write %1: %2").arg(output, out.errorString()));
+
+    Writer w(&out, options.unique);
+    const bool ok = mergeInto(sources, names, w, key, checkOrder, error);
+    out.close();
+    if (!ok) return false;
+    if (out.failed())
+        return setError(error, QObject::tr("Cannot write %1: %2").arg(output, out.errorString()));
+
+    result.rows     = w.rows();
+    result.dropped += w.dropped();
+    ++result.passes;
+    return true;
+}
+
+bool checkOutput(const QStringList& inputs, const QString& output, QString* error)
+{
+    for (const QString& in : inputs)
+        if (QFileInfo(in) == QFileInfo(output))
+            return setError(error, QObject::tr("The output must not be one of the inputs"));
+    return true;
+}
+
+int fanInFor(const ExternalSort::Options& options)
+{
+    return int(qBound(qint64(2), options.memoryBytes / InputBytes, qint64(ExternalSort::MaxFanIn)));
+}
+
+} // namespace
+
+bool ExternalSort::sort(const QStringList& inputs, const QString& output, const Options& options,
+                        Result* result, QString* error)
+{
+    if (!checkOutput(inputs, output, error))
+        return false;
+
+    const Key key(options);
+    const auto less = [&](const Record& a, const Record& b) { return key.compare(a, b) < 0; };
+    Result res;
+    Sources runs;
+    QVector<Record> run;
+    qint64 used = 0;
+
+    const auto spill = [&]() -> bool {
+        std::sort(run.begin(), run.end(), less);
+        std::unique_ptr<QTemporaryFile> file = makeRun(error);
+        if (!file) return false;
+        Writer w(file.get(), options.unique);
+        for (const Record& r : run)
+            if (!w.put(r.line))
+                return setError(error, file->errorString());
+        std::unique_ptr<QIODevice> closed = closeRun(std::move(file), error);
+        if (!closed) return false;
+        res.dropped += w.dropped();
+        runs.push_back(std::move(closed));
+        run.clear();
+        used = 0;
+        return true;
+    };
+
+    QByteArray line;
+    for (const QString& path : inputs)
+    {
+        CompressedDevice in(path);
+        if (!in.open(QIODevice::ReadOnly))
+            return setError(error, QObject::tr("Cannot open %1: %2").arg(path, in.errorString()));
+        while (readLine(&in, &line))
+        {
+            run.append(key.make(line));
+            used += Key::cost(run.last());
+            if (used >= options.memoryBytes && !spill())
+                return false;
+        }
+        in.close();
+        if (in.failed())
+            return setError(error, QObject::tr("Cannot read %1: %2").arg(path, in.errorString()));
+    }
+
+    if (runs.empty())
+    {
+        // Everything fit in the budget: one in-memory sort, no temp files.
+        std::sort(run.begin(), run.end(), less);
+        CompressedDevice out(output);
+        if (!out.open(QIODevice::WriteOnly))
+            return setError(error, QObject::tr("Cannot write %1: %2").arg(output, out.errorString()));
+        Writer w(&out, options.unique);
+        for (const Record& r : run)
+            if (!w.put(r.line)) break;
+        out.close();
+        if (out.failed())
+            return setError(error, QObject::tr("Cannot write %1: %2").arg(output, out.errorString()));
+        res.rows    = w.rows();
+        res.dropped = w.dropped();
+        res.runs    = run.isEmpty() ? 0 : 1;
+        res.passes  = 1;
+        if (result) *result = res;
+        return true;
+    }
+
+    if (!run.isEmpty() && !spill())
+        return false;
+    run.squeeze();
+    res.runs = int(runs.size());
+
+    QStringList names;
+    if (!reduce(runs, names, key, options, fanInFor(options), false, res, error)
+        || !finish(runs, names, output, key, options, false, res, error))
+        return false;
+    if (result) *result = res;
+    return true;
+}
+
+bool ExternalSort::merge(const QStringList& inputs, const QString& output, const Options& options,
+                         Result* result, QString* error)
+{
+    if (!checkOutput(inputs, output, error))
+        return false;
+
+    Sources sources;
+    for (const QString& path : inputs)
+        sources.push_back(std::make_unique<CompressedDevice>(path));
+
+    const Key key(options);
+    Result res;
+    res.runs = int(sources.size());
+    QStringList names = inputs;
+    if (!reduce(sources, names, key, options, fanInFor(options), true, res, error)
+        || !finish(sources, names, output, key, options, res.passes == 0, res, error))
+        return false;
+    if (result) *result = res;
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include <QString>
+#include <QStringList>
+
+#include "catalogmodel.h"
+
+// Sorts and merges catalog files that do not fit in memory. Sorting reads
+// the inputs into runs of at most memoryBytes, sorts each run and spills it
+// to a temp file, then combines the runs with a k-way heap merge (in several
+// passes when there are more than MaxFanIn runs). Merging skips the run
+// phase for inputs that are already sorted. Ties are broken on the whole
+// line, so identical rows end up adjacent and unique can drop them on the
+// way out. Inputs and output may be compressed; the output is the usual
+// tab-separated catalog.
+class ExternalSort
+{
+public:
+    struct Options
+    {
+        int     column      = CatalogModel::NameColumn;
+        bool    descending  = false;
+        bool    unique      = false;
+        qint64  memoryBytes = qint64(256) << 20;
+    };
+
+    struct Result
+    {
+        qint64  rows    = 0;
+        qint64  dropped = 0;
+        int     runs    = 0;
+        int     passes  = 0;
+    };
+
+    static bool sort(const QStringList& inputs, const QString& output, const Options& options,
+                     Result* result, QString* error);
+    static bool merge(const QStringList& inputs, const QString& output, const Options& options,
+                      Result* result, QString* error);
+
+    static constexpr int MaxFanIn = 64;
+};
+
+#endif // EXTERNALSORT_H
@@ -0,0 +1,142 @@
+#include "externalsortdialog.h"
+#include "loghandler.h"
+
+#include <QtConcurrent>
+
+ExternalSortDialog::ExternalSortDialog(QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Sort or merge catalog files"));
+    resize(520, 420);
+
+    m_inputs = new QListWidget(this);
+    m_inputs->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    QPushButton* add    = new QPushButton(tr("Add…"), this);
+    QPushButton* remove = new QPushButton(tr("Remove"), this);
+
+    m_output = new QLineEdit(this);
+    QPushButton* browse = new QPushButton(tr("Browse…"), this);
+
+    m_column = new QComboBox(this);
+    for (int c = 0; c < CatalogModel::ColumnCount; ++c)
+        m_column->addItem(CatalogModel::columnName(c), c);
+
+    m_descending = new QCheckBox(tr("Descending"), this);
+    m_presorted  = new QCheckBox(tr("Inputs are already sorted by this column (merge only)"), this);
+    m_unique     = new QCheckBox(tr("Drop identical rows"), this);
+
+    m_memory = new QSpinBox(this);
+    m_memory->setRange(16, 16384);
+    m_memory->setValue(int(ExternalSort::Options().memoryBytes >> 20));
+    m_memory->setSuffix(tr(" MiB"));
+
+    m_result = new QLabel(this);
+    m_result->setWordWrap(true);
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_run = buttons->addButton(tr("Run"), QDialogButtonBox::ActionRole);
+    m_run->setDefault(true);
+
+    auto inputButtons = new QVBoxLayout;
+    inputButtons->addWidget(add);
+    inputButtons->addWidget(remove);
+    inputButtons->addStretch();
+
+    auto inputLayout = new QHBoxLayout;
+    inputLayout->addWidget(m_inputs, 1);
+    inputLayout->addLayout(inputButtons);
+
+    auto outputLayout = new QHBoxLayout;
+    outputLayout->addWidget(m_output, 1);
+    outputLayout->addWidget(browse);
+
+    auto form = new QFormLayout;
+    form->addRow(tr("Sort by:"), m_column);
+    form->addRow(QString(),      m_descending);
+    form->addRow(QString(),      m_presorted);
+    form->addRow(QString(),      m_unique);
+    form->addRow(tr("Memory:"),  m_memory);
+    form->addRow(tr("Output:"),  outputLayout);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel(tr("Input files:"), this));
+    layout->addLayout(inputLayout, 1);
+    layout->addLayout(form);
+    layout->addWidget(m_result);
+    layout->addWidget(buttons);
+    setLayout(layout);
+
+    const QString filter = tr("Catalogs (*.txt *.gz *.zst);;All Files (*)");
+    connect(add, &QPushButton::clicked, this, [this, filter]() {
+        m_inputs->addItems(QFileDialog::getOpenFileNames(this, tr("Add catalogs"), QString(), filter));
+    });
+    connect(remove, &QPushButton::clicked, this, [this]() {
+        qDeleteAll(m_inputs->selectedItems());
+    });
+    connect(browse, &QPushButton::clicked, this, [this, filter]() {
+        const QString path = QFileDialog::getSaveFileName(this, tr("Output"), m_output->text(), filter);
+        if (!path.isEmpty())
+            m_output->setText(path);
+    });
+    connect(m_run,     &QPushButton::clicked, this, &ExternalSortDialog::run);
+    connect(&m_watcher, &QFutureWatcher<QString>::finished, this, &ExternalSortDialog::finished);
+    connect(buttons,   &QDialogButtonBox::rejected, this, &QDialog::close);
+}
+
+ExternalSortDialog::~ExternalSortDialog()
+{
+    // The task writes into m_stats.
+    m_watcher.waitForFinished();
+}
+
+void ExternalSortDialog::run()
+{
+    QStringList inputs;
+    for (int i = 0; i < m_inputs->count(); ++i)
+        inputs << m_inputs->item(i)->text();
+    const QString output = m_output->text();
+    if (inputs.isEmpty() || output.isEmpty())
+    {
+        m_result->setText(tr("Choose at least one input file and an output file."));
+        return;
+    }
+
+    ExternalSort::Options options;
+    options.column      = m_column->currentData().toInt();
+    options.descending  = m_descending->isChecked();
+    options.unique      = m_unique->isChecked();
+    options.memoryBytes = qint64(m_memory->value()) << 20;
+    const bool presorted = m_presorted->isChecked();
+
+    m_run->setEnabled(false);
+    m_result->setText(presorted ? tr("Merging…") : tr("Sorting…"));
+    m_stats = ExternalSort::Result();
+    m_timer.start();
+
+    m_watcher.setFuture(QtConcurrent::run([this, inputs, output, options, presorted]() {
+        QString error;
+        const bool ok = presorted ? ExternalSort::merge(inputs, output, options, &m_stats, &error)
+                                  : ExternalSort::sort(inputs, output, options, &m_stats, &error);
+        return ok ? QString() : error;
+    }));
+}
+
+void ExternalSortDialog::finished()
+{
+    m_run->setEnabled(true);
+    const QString error = m_watcher.result();
+    if (!error.isEmpty())
+    {
+        qDebug(logWarning()) << "External sort failed:" << error;
+        m_result->setText(error);
+        return;
+    }
+
+    qDebug(logInfo()) << "External sort wrote" << m_stats.rows << "rows from" << m_stats.runs << "runs in"
+                      << m_stats.passes << "merge passes," << m_timer.elapsed() << "ms.";
+    QString text = tr("%n row(s) written", nullptr, int(qMin(m_stats.rows, qint64(INT_MAX))));
+    if (m_stats.dropped > 0)
+        text += tr(", %1 identical rows dropped").arg(m_stats.dropped);
+    text += tr(" (%1 sorted runs, %2 merge passes).").arg(m_stats.runs).arg(m_stats.passes);
+    m_result->setText(text);
+}
@@ -0,0 +1,51 @@
+#ifndef EXTERNALSORTDIALOG_H
+#define EXTERNALSORTDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFileDialog>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+
+#include "externalsort.h"
+
+// Sorts or merges catalog files on disk without loading them into the
+// window; the work runs on the thread pool.
+class ExternalSortDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ExternalSortDialog(QWidget* parent = nullptr);
+    ~ExternalSortDialog() override;
+
+private:
+    void run();
+    void finished();
+
+    QListWidget*    m_inputs   = nullptr;
+    QLineEdit*      m_output   = nullptr;
+    QComboBox*      m_column   = nullptr;
+    QCheckBox*      m_descending = nullptr;
+    QCheckBox*      m_presorted  = nullptr;
+    QCheckBox*      m_unique   = nullptr;
+    QSpinBox*       m_memory   = nullptr;
+    QLabel*         m_result   = nullptr;
+    QPushButton*    m_run      = nullptr;
+
+    QFutureWatcher<QString> m_watcher;
+    ExternalSort::Result    m_stats;
+    QElapsedTimer           m_timer;
+};
+
+#endif // EXTERNALSORTDIALOG_H
@@ -0,0 +1,124 @@
+#include "findreplace.h"
+#include "catalogschema.h"
+
+#include <QtConcurrent>
+#include <QAtomicInt>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+typedef QVector<CatalogModel::CellChange> Changes;
+
+class Replacer
+{
+public:
+    explicit Replacer(const FindReplace::Options& options) : m_options(options)
+    {
+        if (options.regex)
+        {
+            m_re.setPattern(options.find);
+            if (!options.caseSensitive)
+                m_re.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+            m_re.optimize();
+        }
+    }
+
+    bool isValid() const { return !m_options.find.isEmpty() && (!m_options.regex || m_re.isValid()); }
+    QString errorString() const { return m_re.errorString(); }
+
+    // Returns a null string when the text has no match.
+    QString apply(const QString& text) const
+    {
+        const Qt::CaseSensitivity cs = m_options.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+        if (m_options.regex ? !m_re.match(text).hasMatch() : !text.contains(m_options.find, cs))
+            return QString();
+
+        QString result = text;
+        if (m_options.regex)
+            result.replace(m_re, m_options.replace);
+        else
+            result.replace(m_options.find, m_options.replace, cs);
+        return result.isNull() ? QString("") : result;
+    }
+
+private:
+    FindReplace::Options m_options;
+    QRegularExpression   m_re;
+};
+
+void appendChanges(Changes& result, const Changes& part)
+{
+    result += part;
+}
+
+} // namespace
+
+QVector<CatalogModel::CellChange> FindReplace::collect(const CatalogModel* model, const Options& options,
+                                                       int* skipped, QString* error)
+{
+    const Replacer replacer(options);
+    if (!replacer.isValid())
+    {
+        if (error) *error = options.find.isEmpty() ? QObject::tr("Nothing to find") : replacer.errorString();
+        return Changes();
+    }
+
+    const bool allColumns = options.column < 0;
+    const auto wants = [&](int column) { return allColumns || options.column == column; };
+
+    // Every distinct author is rewritten once; rows then look theirs up by id.
+    QVector<QString> authorResult;
+    if (wants(CatalogModel::AuthorColumn))
+    {
+        const AuthorPool& pool = model->authors();
+        authorResult.resize(pool.size());
+        for (int id = 0; id < pool.size(); ++id)
+            if (pool.references(id) > 0)
+                authorResult[id] = replacer.apply(pool.name(id));
+    }
+
+    // The workers scan a snapshot, a block at a time; the items stay with
+    // the GUI thread.
+    const CatalogStore::Snapshot snapshot = model->snapshot();
+    QVector<int> blocks(snapshot.blockCount());
+    std::iota(blocks.begin(), blocks.end(), 0);
+
+    QAtomicInt rejected(0);
+    auto scan = [&](int b) -> Changes {
+        Changes changes;
+        const QVector<CatalogStore::Row>& block = snapshot.block(b);
+        const int start = snapshot.blockStart(b);
+        for (int i = 0; i < block.size(); ++i)
+        {
+            const CatalogStore::Row& row = block.at(i);
+            const int r = start + i;
+            for (int c = 0; c < CatalogModel::ColumnCount; ++c)
+            {
+                if (!wants(c)) continue;
+
+                QString after;
+                const int id = c == CatalogModel::AuthorColumn ? row.authorId : -1;
+                if (id >= 0 && id < authorResult.size())
+                    after = authorResult[id];
+                else
+                    after = replacer.apply(row.text(c));
+
+                const QString& before = row.text(c);
+                if (after.isNull() || after == before) continue;
+                if (c == CatalogModel::PagesColumn && !CatalogSchema::checkPages(after))
+                {
+                    rejected.fetchAndAddRelaxed(1);
+                    continue;
+                }
+                changes.append({ r, c, before, after });
+            }
+        }
+        return changes;
+    };
+
+    Changes result = QtConcurrent::blockingMappedReduced<Changes>(blocks, scan, appendChanges,
+                                                                  QtConcurrent::OrderedReduce);
+    if (skipped) *skipped = rejected.loadRelaxed();
+    return result;
+}
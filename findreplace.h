@@ -0,0 +1,29 @@
+#ifndef FINDREPLACE_H
+#define FINDREPLACE_H
+
+#include <QString>
+#include <QVector>
+#include <QRegularExpression>
+
+#include "catalogmodel.h"
+
+class FindReplace
+{
+public:
+    struct Options
+    {
+        QString find;
+        QString replace;
+        bool    regex         = false;
+        bool    caseSensitive = false;
+        int     column        = -1;     // -1 for every column
+    };
+
+    // Cells that would change, scanned from a snapshot of the rows on the
+    // global thread pool. Author cells are rewritten once per pooled name. Replacements
+    // that would leave Pages invalid are left out and counted in *skipped.
+    static QVector<CatalogModel::CellChange> collect(const CatalogModel* model, const Options& options,
+                                                     int* skipped = nullptr, QString* error = nullptr);
+};
+
+#endif // FINDREPLACE_H
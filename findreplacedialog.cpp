@@ -0,0 +1,55 @@
+#include "findreplacedialog.h"
+
+FindReplaceDialog::FindReplaceDialog(QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Find and replace"));
+
+    m_find    = new QLineEdit(this);
+    m_replace = new QLineEdit(this);
+
+    m_column = new QComboBox(this);
+    m_column->addItem(tr("All columns"), -1);
+    for (int c = 0; c < CatalogModel::ColumnCount; ++c)
+        m_column->addItem(CatalogModel::columnName(c), c);
+
+    m_regex = new QCheckBox(tr("Regular expression"), this);
+    m_case  = new QCheckBox(tr("Match case"), this);
+    m_result = new QLabel(this);
+
+    auto form = new QFormLayout;
+    form->addRow(tr("Find:"),    m_find);
+    form->addRow(tr("Replace:"), m_replace);
+    form->addRow(tr("In:"),      m_column);
+    form->addRow(QString(),      m_regex);
+    form->addRow(QString(),      m_case);
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton* replaceAll = buttons->addButton(tr("Replace all"), QDialogButtonBox::ActionRole);
+    replaceAll->setDefault(true);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addWidget(m_result);
+    layout->addWidget(buttons);
+    setLayout(layout);
+
+    connect(replaceAll, &QPushButton::clicked, this, &FindReplaceDialog::replaceAllRequested);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::close);
+}
+
+FindReplace::Options FindReplaceDialog::options() const
+{
+    FindReplace::Options o;
+    o.find          = m_find->text();
+    o.replace       = m_replace->text();
+    o.regex         = m_regex->isChecked();
+    o.caseSensitive = m_case->isChecked();
+    o.column        = m_column->currentData().toInt();
+    return o;
+}
+
+void FindReplaceDialog::setResult(const QString& text)
+{
+    m_result->setText(text);
+}
@@ -0,0 +1,38 @@
+#ifndef FINDREPLACEDIALOG_H
+#define FINDREPLACEDIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QVBoxLayout>
+
+#include "findreplace.h"
+
+class FindReplaceDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit FindReplaceDialog(QWidget* parent = nullptr);
+
+    FindReplace::Options options() const;
+    void setResult(const QString& text);
+
+signals:
+    void replaceAllRequested();
+
+private:
+    QLineEdit*  m_find    = nullptr;
+    QLineEdit*  m_replace = nullptr;
+    QComboBox*  m_column  = nullptr;
+    QCheckBox*  m_regex   = nullptr;
+    QCheckBox*  m_case    = nullptr;
+    QLabel*     m_result  = nullptr;
+};
+
+#endif // FINDREPLACEDIALOG_H
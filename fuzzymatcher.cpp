@@ -0,0 +1,124 @@
+#include "fuzzymatcher.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <numeric>
+
+FuzzyMatcher::FuzzyMatcher(const QString& pattern)
+{
+    const QString folded = pattern.left(64).toCaseFolded();
+    m_length = folded.size();
+
+    for (int i = 0; i < m_length; ++i)
+    {
+        const char16_t ch = folded[i].unicode();
+        const quint64 bit = quint64(1) << i;
+        if (ch < 256) m_latin1[ch] |= bit;
+        else          m_other[ch] |= bit;
+    }
+
+    // Fold the Latin-1 table up front so the common path needs no case
+    // conversion per text character.
+    for (int ch = 0; ch < 256; ++ch)
+    {
+        const uint f = QChar::toCaseFolded(char32_t(ch));
+        if (f != uint(ch))
+            m_latin1[ch] = f < 256 ? m_latin1[f] : m_other.value(f);
+    }
+}
+
+quint64 FuzzyMatcher::peq(char16_t ch) const
+{
+    if (ch < 256) return m_latin1[ch];
+    return m_other.value(uint(QChar::toCaseFolded(char32_t(ch))));
+}
+
+int FuzzyMatcher::distance(const QString& text) const
+{
+    if (m_length == 0) return 0;
+
+    const quint64 high = quint64(1) << (m_length - 1);
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = m_length;
+    int best  = m_length;
+
+    const QChar* p   = text.constData();
+    const QChar* end = p + text.size();
+    for (; p != end; ++p)
+    {
+        const quint64 eq = peq(p->unicode());
+        const quint64 xv = eq | mv;
+        const quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+
+        if (ph & high)      ++score;
+        else if (mh & high) --score;
+
+        // Without the usual "| 1" a match may start anywhere in the text.
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score < best)
+        {
+            best = score;
+            if (best == 0) break;
+        }
+    }
+    return best;
+}
+
+int FuzzyMatcher::rowDistance(const CatalogModel* model, int row, const QVector<quint8>& authorDistances) const
+{
+    int best = NoMatch;
+    const int id = model->authorId(row);
+    if (id >= 0 && id < authorDistances.size())
+        best = authorDistances[id];
+    else if (const QStandardItem* a = model->item(row, CatalogModel::AuthorColumn))
+        best = distance(a->text());
+
+    if (best > 0)
+        if (const QStandardItem* n = model->item(row, CatalogModel::NameColumn))
+            best = std::min(best, distance(n->text()));
+    return std::min(best, int(NoMatch));
+}
+
+int FuzzyMatcher::rowDistance(const CatalogStore::Row& row, const QVector<quint8>& authorDistances) const
+{
+    int best = NoMatch;
+    if (row.authorId >= 0 && row.authorId < authorDistances.size())
+        best = authorDistances[row.authorId];
+    else
+        best = distance(row.author);
+
+    if (best > 0)
+        best = std::min(best, distance(row.name));
+    return std::min(best, int(NoMatch));
+}
+
+QVector<quint8> FuzzyMatcher::scanRows(const CatalogModel* model) const
+{
+    const AuthorPool& pool = model->authors();
+    QVector<quint8> authorDistances(pool.size());
+    for (int id = 0; id < pool.size(); ++id)
+        authorDistances[id] = quint8(std::min(distance(pool.name(id)), int(NoMatch)));
+
+    // Workers only read the snapshot, never the model's items; each block
+    // writes a disjoint slice of the result.
+    const CatalogStore::Snapshot snapshot = model->snapshot();
+    QVector<quint8> result(snapshot.rowCount(), quint8(NoMatch));
+    QVector<int> blocks(snapshot.blockCount());
+    std::iota(blocks.begin(), blocks.end(), 0);
+
+    quint8* out = result.data();
+    QtConcurrent::blockingMap(blocks, [&](int b) {
+        const QVector<CatalogStore::Row>& block = snapshot.block(b);
+        quint8* slice = out + snapshot.blockStart(b);
+        for (int i = 0; i < block.size(); ++i)
+            slice[i] = quint8(rowDistance(block.at(i), authorDistances));
+    });
+    return result;
+}
@@ -0,0 +1,45 @@
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <array>
+
+#include "catalogmodel.h"
+
+// Case-insensitive approximate substring matching with Myers' bit-parallel
+// edit-distance algorithm: the whole pattern is advanced one text character
+// at a time in a single 64-bit word. Patterns longer than 64 characters are
+// truncated.
+class FuzzyMatcher
+{
+public:
+    static constexpr int NoMatch = 255;
+
+    FuzzyMatcher() = default;
+    explicit FuzzyMatcher(const QString& pattern);
+
+    bool isEmpty() const    { return m_length == 0; }
+    int  length() const     { return m_length; }
+
+    // Smallest edit distance between the pattern and any substring of text.
+    int distance(const QString& text) const;
+
+    // Best distance of every row of the catalog over its Name and Author
+    // columns; authors are matched once per pooled name. The blocks of a
+    // snapshot of the rows are scanned on the global thread pool.
+    QVector<quint8> scanRows(const CatalogModel* model) const;
+
+    int rowDistance(const CatalogModel* model, int row, const QVector<quint8>& authorDistances) const;
+    int rowDistance(const CatalogStore::Row& row, const QVector<quint8>& authorDistances) const;
+
+private:
+    quint64 peq(char16_t ch) const;
+
+    int                         m_length = 0;
+    std::array<quint64, 256>    m_latin1 {};
+    QHash<uint, quint64>        m_other;
+};
+
+#endif // FUZZYMATCHER_H
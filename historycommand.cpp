@@ -0,0 +1,100 @@
+#include "historycommand.h"
+
+#include <QIODevice>
+
+void HistoryCommand::writeNumber(QDataStream& out, quint64 value)
+{
+    while (value >= 0x80)
+    {
+        out << quint8(value | 0x80);
+        value >>= 7;
+    }
+    out << quint8(value);
+}
+
+quint64 HistoryCommand::readNumber(QDataStream& in)
+{
+    quint64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        quint8 byte = 0;
+        in >> byte;
+        if (in.status() != QDataStream::Ok)
+            return 0;
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    in.setStatus(QDataStream::ReadCorruptData);
+    return 0;
+}
+
+void HistoryCommand::writeDelta(QDataStream& out, qint64 value)
+{
+    writeNumber(out, (quint64(value) << 1) ^ quint64(value >> 63));
+}
+
+qint64 HistoryCommand::readDelta(QDataStream& in)
+{
+    const quint64 v = readNumber(in);
+    return qint64(v >> 1) ^ -qint64(v & 1);
+}
+
+void HistoryCommand::writeText(QDataStream& out, const QString& text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    writeNumber(out, quint64(utf8.size()));
+    out.writeRawData(utf8.constData(), int(utf8.size()));
+}
+
+QString HistoryCommand::readText(QDataStream& in)
+{
+    const quint64 size = readNumber(in);
+    if (in.status() != QDataStream::Ok)
+        return QString();
+    if (!in.device() || size > quint64(in.device()->bytesAvailable()))
+    {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return QString();
+    }
+    QByteArray utf8(qsizetype(size), Qt::Uninitialized);
+    in.readRawData(utf8.data(), int(size));
+    return QString::fromUtf8(utf8);
+}
+
+// Cell edits usually touch a few characters, so the old value is stored as
+// the lengths it shares with the new one at either end and its middle.
+void HistoryCommand::writeChange(QDataStream& out, const QString& before, const QString& after)
+{
+    const int n = int(qMin(before.size(), after.size()));
+    int prefix = 0;
+    while (prefix < n && before[prefix] == after[prefix])
+        ++prefix;
+    int suffix = 0;
+    while (suffix < n - prefix && before[before.size() - 1 - suffix] == after[after.size() - 1 - suffix])
+        ++suffix;
+    // Never split a surrogate pair; the middle is written as UTF-8.
+    if (prefix > 0 && after[prefix - 1].isHighSurrogate())
+        --prefix;
+    if (suffix > 0 && after[after.size() - suffix].isLowSurrogate())
+        --suffix;
+
+    writeText(out, after);
+    writeNumber(out, quint64(prefix));
+    writeNumber(out, quint64(suffix));
+    writeText(out, before.mid(prefix, before.size() - prefix - suffix));
+}
+
+void HistoryCommand::readChange(QDataStream& in, QString* before, QString* after)
+{
+    *after = readText(in);
+    const quint64 prefix = readNumber(in);
+    const quint64 suffix = readNumber(in);
+    const QString middle = readText(in);
+    if (prefix + suffix > quint64(after->size()))
+    {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return;
+    }
+    *before = after->left(qsizetype(prefix)) + middle + after->right(qsizetype(suffix));
+}
@@ -0,0 +1,48 @@
+#ifndef HISTORYCOMMAND_H
+#define HISTORYCOMMAND_H
+
+#include <QUndoCommand>
+#include <QDataStream>
+#include <QString>
+
+// Base of the catalog's undo commands. Each one can write itself to the
+// history sidecar (see UndoHistory) and remembers where it was stored, so
+// a later save appends only commands that are new.
+class HistoryCommand : public QUndoCommand
+{
+public:
+    enum Type : quint8 { CellEdit = 1, BatchEdit = 2, AddRow = 3, RemoveRows = 4 };
+
+    explicit HistoryCommand(QUndoCommand* parent = nullptr) : QUndoCommand(parent) {}
+
+    virtual Type type() const = 0;
+    virtual void write(QDataStream& out) const = 0;
+
+    qint64 storedAt() const                 { return m_offset; }
+    int    storedSize() const               { return m_size; }
+    void   setStored(qint64 offset, int size) { m_offset = offset; m_size = size; }
+
+    // Set by UndoHistory on the commands it rebuilds the stack from: the
+    // model already holds the result, so undo() and redo() leave it alone.
+    bool   muted() const                    { return m_muted; }
+    void   setMuted(bool on)                { m_muted = on; }
+
+    // Compact encodings shared by the commands: variable-length numbers,
+    // zigzag deltas, UTF-8 text and an edit stored as the new value plus
+    // the part of the old one that differs.
+    static void    writeNumber(QDataStream& out, quint64 value);
+    static quint64 readNumber(QDataStream& in);
+    static void    writeDelta(QDataStream& out, qint64 value);
+    static qint64  readDelta(QDataStream& in);
+    static void    writeText(QDataStream& out, const QString& text);
+    static QString readText(QDataStream& in);
+    static void    writeChange(QDataStream& out, const QString& before, const QString& after);
+    static void    readChange(QDataStream& in, QString* before, QString* after);
+
+private:
+    qint64 m_offset = -1;
+    int    m_size   = 0;
+    bool   m_muted  = false;
+};
+
+#endif // HISTORYCOMMAND_H
@@ -8,7 +8,7 @@ Q_LOGGING_CATEGORY(logCritical, "Critical")
 LogHandler* LogHandler::l_instance = nullptr;
 LogHandler logHandler;
 
-LogHandler::LogHandler() : l_mutex()
+LogHandler::LogHandler() : l_mutex(), l_backlogStream(&l_backlog)
 {
     if(l_instance)
     {
@@ -71,32 +71,56 @@ void LogHandler::addTextStream(QTextStream& s)
 void LogHandler::addFile(const QString& filepath)
 {
     QMutexLocker locker(&l_mutex);
-    QFileInfo fi(filepath);
-    QDir dir = fi.absoluteDir();
-    if(!dir.exists()) 
+    l_pendingFiles.append(filepath);
+    if(!l_streams.contains(&l_backlogStream))
+        l_streams.append(&l_backlogStream);
+}
+
+void LogHandler::openFiles()
+{
+    QStringList failed;
     {
-        if(!QDir().mkpath(dir.absolutePath()))
-        {
-            qDebug(logWarning()) << "Failed to create log directory: " << dir.absolutePath();
+        QMutexLocker locker(&l_mutex);
+        if(l_pendingFiles.isEmpty())
             return;
-        }
-    }
+        l_streams.removeAll(&l_backlogStream);
+        l_backlogStream.flush();
 
+        for(const QString& filepath : l_pendingFiles)
+        {
+            QFileInfo fi(filepath);
+            QDir dir = fi.absoluteDir();
+            if(!dir.exists() && !QDir().mkpath(dir.absolutePath()))
+            {
+                failed << dir.absolutePath();
+                continue;
+            }
 
-    QFile* file = new QFile(filepath);
-    if(!file->open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        qDebug(logWarning()) << "Could not open file " << filepath << " for writing.";
-        delete file;
-    } else {
-        l_files.append(file);
-        l_ownedStreams.append(new QTextStream(file));
-        l_streams.append(*l_ownedStreams.rbegin());
+            QFile* file = new QFile(filepath);
+            if(!file->open(QIODevice::WriteOnly | QIODevice::Text))
+            {
+                failed << filepath;
+                delete file;
+            } else {
+                l_files.append(file);
+                l_ownedStreams.append(new QTextStream(file));
+                *l_ownedStreams.last() << l_backlog;
+                l_ownedStreams.last()->flush();
+                l_streams.append(l_ownedStreams.last());
+            }
+        }
+        l_pendingFiles.clear();
+        l_backlog.clear();
     }
+
+    // Logged outside the lock, the handler takes it again.
+    for(const QString& path : failed)
+        qDebug(logWarning()) << "Could not open log file " << path << " for writing.";
 }
 
 void LogHandler::close()
 {
+    openFiles();
     QMutexLocker locker(&l_mutex);
     for(int i = 0; i < l_files.size(); i++)
     {
@@ -26,7 +26,10 @@ public:
     static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
 
     void addTextStream(QTextStream& s);
+    // Files are opened by openFiles(); until then their lines are kept in
+    // memory, so startup does not wait on the disk.
     void addFile(const QString& filename);
+    void openFiles();
     void close();
 
     LogHandler(const LogHandler&) = delete;
@@ -40,6 +43,9 @@ private:
     QVector<QTextStream*>   l_streams;
     QVector<QTextStream*>   l_ownedStreams;
     QVector<QFile*>         l_files;
+    QStringList             l_pendingFiles;
+    QString                 l_backlog;
+    QTextStream             l_backlogStream;
 
     static LogHandler*      l_instance;
 
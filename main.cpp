@@ -6,6 +6,8 @@ int main(int argc, char *argv[])
 {
     // 1) Create the QApplication instance
     QApplication app(argc, argv);
+    QApplication::setOrganizationName("Laba");
+    QApplication::setApplicationName("laba2");
 
     // 2) Instantiate and show your MainWindow
     MainWindow w;
@@ -5,11 +5,14 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
       ui(new Ui::MainWindow)
   {
+    startupTimer.start();
     initializeLogHandler();
     initializeMainWindow();
     initializeApp();
     initializeMenuBar();
     this->newDocument();
+    // The last catalog is brought back once the window is on screen.
+    QTimer::singleShot(0, this, &MainWindow::restoreSession);
   }
 
 MainWindow::~MainWindow()
@@ -30,7 +33,8 @@ void MainWindow::initializeLogHandler()
 void MainWindow::initializeMainWindow()
 {
   ui->setupUi(this);
-  this->setFixedSize(500,300);
+  this->setMinimumSize(500,300);
+  this->resize(900,500);
   qDebug(logInfo()) << "Main window initialized.";
 }
 
@@ -42,6 +46,11 @@ void MainWindow::initializeMenuBar()
   saveFileAct = fileMenu->addAction(tr("&Save"), QKeySequence::Save, this, &MainWindow::slotSaveFileAct);
   saveFileAsAct = fileMenu->addAction(tr("&Save as…"), QKeySequence::SaveAs, this, &MainWindow::slotSaveFileAsAct);
   fileMenu->addSeparator();
+  followFileAct = fileMenu->addAction(tr("&Follow file changes"));
+  followFileAct->setCheckable(true);
+  followFileAct->setToolTip(tr("Merge rows that other programs change or append to the open file"));
+  connect(followFileAct, &QAction::toggled, this, &MainWindow::updateFollow);
+  fileMenu->addSeparator();
   exitAct     = fileMenu->addAction(tr("E&xit"), QKeySequence::Quit, this, &MainWindow::slotExitAct);
 
   editMenu = menuBar()->addMenu(tr("&Edit"));
@@ -51,6 +60,33 @@ void MainWindow::initializeMenuBar()
   copyAct  = editMenu->addAction(tr("&Copy"), QKeySequence::Copy, this, &MainWindow::slotCopyAct);
   pasteAct = editMenu->addAction(tr("&Paste"), QKeySequence::Paste, this, &MainWindow::slotPasteAct);
   cutAct   = editMenu->addAction(tr("Cu&t"), QKeySequence::Cut, this, &MainWindow::slotCutAct);
+  editMenu->addSeparator();
+  editMenu->addAction(tr("&Find and replace…"), QKeySequence::Replace, this, [this]() { app->showFindReplace(); });
+
+  viewMenu = menuBar()->addMenu(tr("&View"));
+  viewMenu->addAction(statsDock->toggleViewAction());
+  viewMenu->addAction(tr("&Validation report…"), this, [this]() { app->showValidationReport(); });
+
+  toolsMenu = menuBar()->addMenu(tr("&Tools"));
+  toolsMenu->addAction(tr("Find &duplicates…"), this, [this]() { app->showDuplicates(); });
+  toolsMenu->addAction(tr("&Sort or merge files…"), this, [this]() {
+    if (!externalSortDialog)
+      externalSortDialog = new ExternalSortDialog(this);
+    externalSortDialog->show();
+    externalSortDialog->raise();
+  });
+  toolsMenu->addSeparator();
+  serveAct = toolsMenu->addAction(tr("&Accept connections from other programs"));
+  serveAct->setCheckable(true);
+  serveAct->setToolTip(tr("Let other programs query the catalog and append rows over a local socket"));
+  connect(serveAct, &QAction::toggled, this, [this](bool on) {
+    if (!app->setServerEnabled(on))
+    {
+      QMessageBox::warning(this, tr("Error"), tr("Cannot accept connections; see the log for details."));
+      QSignalBlocker blocker(serveAct);
+      serveAct->setChecked(false);
+    }
+  });
 
   helpMenu = menuBar()->addMenu(tr("&Help"));
   aboutAct = helpMenu->addAction(tr("&About"), this, &MainWindow::slotAboutAct);
@@ -63,6 +99,12 @@ void MainWindow::initializeApp()
 {
   app = new ContentWindow(this);
   this->setCentralWidget(app);
+  connect(&saveWatcher, &QFutureWatcherBase::finished, this, &MainWindow::finishSave);
+
+  statsDock = new QDockWidget(tr("Statistics"), this);
+  statsDock->setObjectName("statsDock");
+  statsDock->setWidget(app->statsPanel());
+  this->addDockWidget(Qt::RightDockWidgetArea, statsDock);
   qDebug(logInfo()) << "App initialized.";
 }
 
@@ -79,7 +121,7 @@ void MainWindow::slotSaveFileAct()
 {
   qDebug(logInfo()) << "Save file action called.";
   if (saveFile())
-    qDebug(logInfo()) << "Document saved.";
+    qDebug(logInfo()) << "Document save started.";
   else
     qDebug(logWarning()) << "Save cancelled or failed.";
 }
@@ -88,14 +130,15 @@ void MainWindow::slotSaveFileAsAct()
 {
   qDebug(logInfo()) << "Save file as action called.";
   if(saveFileAs())
-    qDebug(logInfo()) << "Saved successfully.";
+    qDebug(logInfo()) << "Save started.";
   else 
     qDebug(logWarning()) << "Save cancelled or failed.";
 }
 
 bool MainWindow::saveFileAs()
 {
-  QString fn = QFileDialog::getSaveFileName(this, tr("Save As"), QString(), tr("Text Files (*.txt);;All Files (*)"));
+  QString fn = QFileDialog::getSaveFileName(this, tr("Save As"), QString(),
+                                            tr("Text Files (*.txt);;Compressed Catalogs (*.gz *.zst);;All Files (*)"));
   if (fn.isEmpty())
     return false;
 
@@ -109,28 +152,81 @@ bool MainWindow::saveFile()
   return saveToFile(currentFile);
 }
 
+// Writes a snapshot of the rows on the thread pool, so editing can go on
+// meanwhile; finishSave() reports the result.
 bool MainWindow::saveToFile(const QString &fileName)
 {
+  waitForSave();
   qDebug(logInfo()) << "Trying to save to " << fileName;
-  QFile file(fileName);
-  if (!file.open(QFile::WriteOnly | QFile::Text)) {
-    QMessageBox::warning( this, tr("Error"), tr("Cannot write file %1:\n%2").arg(QDir::toNativeSeparators(fileName), file.errorString()));
-    qDebug(logWarning) << tr("Cannot write file %1:\n%2").arg(QDir::toNativeSeparators(fileName), file.errorString());
+
+  // Our own writes must not come back as external changes.
+  app->follow(QString());
+
+  // The undo history is taken with the rows and written after them, since
+  // it records the size and time of the file it belongs to.
+  const CatalogStore::Snapshot rows = app->snapshot();
+  UndoHistory::SavePlan history = app->prepareHistory(fileName);
+  savingFile    = fileName;
+  savingVersion = rows.version();
+  saveWatcher.setFuture(QtConcurrent::run([fileName, rows, history]() mutable -> SaveResult {
+    QElapsedTimer timer;
+    timer.start();
+    CompressedDevice file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Text))
+      return { file.errorString(), history };
+
+    const bool written = ContentWindow::write(file, rows);
+    file.close();
+    if (!written || file.failed())
+      return { file.errorString(), history };
+    qDebug(logInfo()) << "Saved" << fileName << "in" << timer.elapsed() << "ms.";
+    UndoHistory::write(history);
+    return { QString(), history };
+  }));
+  return true;
+}
+
+bool MainWindow::waitForSave()
+{
+  if (savingFile.isEmpty())
+    return lastSaveOk;
+  saveWatcher.waitForFinished();
+  return finishSave();
+}
+
+// Runs once per save, from the watcher or from waitForSave(), whichever
+// comes first.
+bool MainWindow::finishSave()
+{
+  if (savingFile.isEmpty() || !saveWatcher.isFinished())
+    return lastSaveOk;
+  const QString fileName = savingFile;
+  savingFile.clear();
+
+  const SaveResult result = saveWatcher.result();
+  const QString& error = result.error;
+  lastSaveOk = error.isEmpty();
+  if (!lastSaveOk) {
+    app->finishHistory(result.history, false);
+    QMessageBox::warning( this, tr("Error"), tr("Cannot write file %1:\n%2").arg(QDir::toNativeSeparators(fileName), error));
+    qDebug(logWarning) << tr("Cannot write file %1:\n%2").arg(QDir::toNativeSeparators(fileName), error);
+    updateFollow();
     return false;
   }
 
-  QTextStream out(&file);
-  app->write(out);
-  file.close();
-
-  currentFile = fileName;
-  app->setModified(false);
-  setWindowTitle(QFileInfo(currentFile).fileName() + tr(" - ") + appName);
+  // Edits made while the snapshot was written are still unsaved, and are
+  // not in the undo history just written either.
+  const bool edited = app->version() != savingVersion;
+  setCurrentFile(fileName);
+  if (edited)
+    app->setModified(true);
+  app->finishHistory(result.history, !edited);
   return true;
 }
 
 bool MainWindow::maybeSave()
 {
+  waitForSave();
   if(!app->isModified())
     return true;
   qDebug(logInfo()) << "Asking user to save.";
@@ -143,7 +239,7 @@ bool MainWindow::maybeSave()
 
   switch (ret) {
     case QMessageBox::Save:
-      return saveFile();
+      return saveFile() && waitForSave();
     case QMessageBox::Cancel:
       return false;
     default:
@@ -160,25 +256,50 @@ void MainWindow::slotExitAct()
 void MainWindow::slotOpenFileAct()
 {
   qDebug(logInfo()) << "Open file action called.";
-  QString path = QFileDialog::getOpenFileName(this, tr("Open File"), QString(), tr("Text Files (*.txt);;All Files (*)"));
+  QString path = QFileDialog::getOpenFileName(this, tr("Open File"), QString(),
+                                              tr("Catalogs (*.txt *.gz *.zst);;Text Files (*.txt);;All Files (*)"));
   if(path.isEmpty()) return;
+  openFile(path);
+}
+
+bool MainWindow::openFile(const QString& path)
+{
+  waitForSave();
 
-  QFile f(path);
+  // Compressed catalogs are inflated on a worker thread while they are parsed.
+  CompressedDevice f(path);
   if(!f.open(QIODevice::ReadOnly | QIODevice::Text)){
-    QMessageBox::warning(this, tr("Error"), tr("Cannot open file %1").arg(path));
-    qDebug(logWarning()) << tr("Cannot open file %1").arg(path);
-    return;
+    QMessageBox::warning(this, tr("Error"), tr("Cannot open file %1:\n%2").arg(path, f.errorString()));
+    qDebug(logWarning()) << tr("Cannot open file %1").arg(path) << f.errorString();
+    return false;
   }
 
-  QTextStream in(&f);
-  app->read(in);
+  app->read(f);
   f.close();
+  // A damaged archive yields only part of the catalog; keeping that under
+  // the file's name would let the next save overwrite the archive with it.
+  if(f.failed()){
+    QMessageBox::warning(this, tr("Error"), tr("Cannot read file %1:\n%2").arg(path, f.errorString()));
+    qDebug(logWarning()) << tr("Cannot read file %1").arg(path) << f.errorString();
+    app->clear();
+    currentFile.clear();
+    updateFollow();
+    setWindowTitle(tr("Untitled - ") + appName);
+    return false;
+  }
+
+  setCurrentFile(path);
+  app->loadHistory(path);
+  qDebug(logInfo()) << "Opened: " << path;
+  return true;
+}
 
+void MainWindow::setCurrentFile(const QString& path)
+{
   currentFile = path;
   app->setModified(false);
+  updateFollow();
   this->setWindowTitle(QFileInfo(currentFile).fileName() + tr(" - ") + appName);
-
-  qDebug(logInfo()) << "Opened: " << path;
 }
 
 // ---------------------------------------------
@@ -237,6 +358,50 @@ void MainWindow::closeEvent(QCloseEvent *event)
 void MainWindow::onExit()
 {
   qDebug(logInfo()) << "On exit event called.";
+  waitForSave();
+  saveSession();
+}
+
+// ---------------------------------------------------------------
+
+void MainWindow::restoreSession()
+{
+  QSettings settings;
+  settings.beginGroup("session");
+  const QString path = settings.value("file").toString();
+  if (!path.isEmpty() && QFileInfo::exists(path))
+  {
+    const bool fromSnapshot = app->restoreSnapshot(path);
+    if (fromSnapshot)
+    {
+      setCurrentFile(path);
+      app->loadHistory(path);
+    }
+    if (fromSnapshot || openFile(path))
+    {
+      app->restoreViewState(settings);
+      qDebug(logInfo()) << "Startup: catalog usable after" << startupTimer.elapsed() << "ms"
+                        << (fromSnapshot ? "(snapshot)." : "(parsed).");
+    }
+  }
+  else
+    qDebug(logInfo()) << "Startup: window usable after" << startupTimer.elapsed() << "ms.";
+  settings.endGroup();
+
+  logHandler.openFiles();
+}
+
+void MainWindow::saveSession()
+{
+  QSettings settings;
+  settings.beginGroup("session");
+  settings.setValue("file", currentFile);
+  app->saveViewState(settings);
+  settings.endGroup();
+
+  // Unsaved edits would make the snapshot disagree with the file.
+  if (!currentFile.isEmpty() && !app->isModified())
+    app->saveSnapshot(currentFile);
 }
 
 void MainWindow::showAppInfo()
@@ -253,5 +418,13 @@ void MainWindow::newDocument()
   app->clear();
   app->setModified(false);
   currentFile.clear();
+  updateFollow();
   setWindowTitle(tr("Untitled - ") + appName);
+}
+
+void MainWindow::updateFollow()
+{
+  // Only plain files can be diffed chunk by chunk.
+  const bool plain = CompressedDevice::detect(currentFile) == CompressedDevice::Plain;
+  app->follow(followFileAct->isChecked() && plain ? currentFile : QString());
 }
\ No newline at end of file
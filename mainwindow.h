@@ -9,6 +9,8 @@
 #include "infodialog.h"
 #include "loghandler.h"
 #include "contentwindow.h"
+#include "compresseddevice.h"
+#include "externalsortdialog.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -54,6 +56,13 @@ protected:
     bool     saveFile();
     bool     saveFileAs();
     bool     saveToFile(const QString &fileName);
+    bool     waitForSave();
+    bool     finishSave();
+    void     updateFollow();
+    bool     openFile(const QString& path);
+    void     setCurrentFile(const QString& path);
+    void     restoreSession();
+    void     saveSession();
 
 
 private:
@@ -61,17 +70,33 @@ private:
 
     Ui::MainWindow *ui;
     ContentWindow* app;
+    QDockWidget*   statsDock;
+    ExternalSortDialog* externalSortDialog = nullptr;
 
     QString  currentFile;       // empty == untitled
+    struct SaveResult
+    {
+      QString error;
+      UndoHistory::SavePlan history;
+    };
+    QFutureWatcher<SaveResult> saveWatcher;
+    QString  savingFile;        // set while a save runs in the background
+    quint64  savingVersion = 0;
+    bool     lastSaveOk = true;
+    QElapsedTimer startupTimer;
 
     QMenu* fileMenu;
     QMenu* editMenu;
+    QMenu* viewMenu;
+    QMenu* toolsMenu;
     QMenu* helpMenu;
 
     QAction* newFileAct;
     QAction* openFileAct;
     QAction* saveFileAct;
     QAction* saveFileAsAct;
+    QAction* followFileAct;
+    QAction* serveAct;
     QAction* exitAct;
 
     QAction* undoAct;
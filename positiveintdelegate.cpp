@@ -1,17 +1,18 @@
 #include "positiveintdelegate.h"
+#include "catalogschema.h"
 
-PositiveIntDelegate::PositiveIntDelegate(QObject* parent) : QStyledItemDelegate(parent) 
+PositiveIntDelegate::PositiveIntDelegate(QObject* parent) : CachedTextDelegate(parent) 
 {
-  
+  setNumeric(true);
 }
 
 QWidget* PositiveIntDelegate::createEditor(QWidget* parent, const QStyleOptionViewItem&, const QModelIndex& index) const
 {
     if(index.column()==2) {
         QLineEdit* e = new QLineEdit(parent);
-        e->setValidator(new QIntValidator(1, 1000000000, e));
+        e->setValidator(CatalogSchema::pagesValidator(e));
         return e;
     }
-    return QStyledItemDelegate::createEditor(parent, {}, index);
+    return CachedTextDelegate::createEditor(parent, {}, index);
 }
 
@@ -5,7 +5,9 @@
 #include <QLineEdit>
 #include <QIntValidator>
 
-class PositiveIntDelegate : public QStyledItemDelegate {
+#include "cachedtextdelegate.h"
+
+class PositiveIntDelegate : public CachedTextDelegate {
 public:
   PositiveIntDelegate(QObject* parent=nullptr);
   
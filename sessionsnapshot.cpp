@@ -0,0 +1,151 @@
+#include "sessionsnapshot.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+const quint32 Magic   = 0x4c425353;     // "LBSS"
+const quint16 Version = 1;
+
+struct Stamp
+{
+    QString path;
+    qint64  size     = -1;
+    qint64  modified = -1;
+
+    static Stamp of(const QString& source)
+    {
+        const QFileInfo fi(source);
+        Stamp s;
+        s.path = fi.absoluteFilePath();
+        if (fi.exists())
+        {
+            s.size     = fi.size();
+            s.modified = fi.lastModified().toMSecsSinceEpoch();
+        }
+        return s;
+    }
+
+    bool operator==(const Stamp& o) const
+    {
+        return path == o.path && size == o.size && modified == o.modified;
+    }
+};
+
+QDataStream& operator<<(QDataStream& out, const Stamp& s) { return out << s.path << s.size << s.modified; }
+QDataStream& operator>>(QDataStream& in, Stamp& s)        { return in >> s.path >> s.size >> s.modified; }
+
+bool readHeader(QDataStream& in, const QString& source)
+{
+    quint32 magic = 0;
+    quint16 version = 0;
+    Stamp stamp;
+    in >> magic >> version;
+    if (magic != Magic || version != Version)
+        return false;
+    in >> stamp;
+    return in.status() == QDataStream::Ok && stamp.size >= 0 && stamp == Stamp::of(source);
+}
+
+} // namespace
+
+QString SessionSnapshot::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/session.snapshot";
+}
+
+bool SessionSnapshot::isFresh(const QString& source, const QString& path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_6_0);
+    return readHeader(in, source);
+}
+
+bool SessionSnapshot::save(const CatalogModel* model, const QString& source, const QString& path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << Magic << Version << Stamp::of(source);
+
+    // Only authors still in use are written, renumbered densely.
+    const AuthorPool& pool = model->authors();
+    QVector<qint32> index(pool.size(), -1);
+    qint32 authors = 0;
+    for (int id = 0; id < pool.size(); ++id)
+        if (pool.references(id) > 0)
+            index[id] = authors++;
+    out << authors;
+    for (int id = 0; id < pool.size(); ++id)
+        if (index[id] >= 0)
+            out << pool.name(id);
+
+    const qint32 rows = model->rowCount();
+    out << rows;
+    for (int r = 0; r < rows; ++r)
+    {
+        const QStandardItem* name  = model->item(r, CatalogModel::NameColumn);
+        const QStandardItem* pages = model->item(r, CatalogModel::PagesColumn);
+        const int id = model->authorId(r);
+        out << (name ? name->text() : QString())
+            << (id >= 0 && id < index.size() ? index[id] : qint32(-1))
+            << (pages ? pages->text() : QString());
+    }
+
+    return out.status() == QDataStream::Ok && f.commit();
+}
+
+bool SessionSnapshot::load(CatalogModel* model, const QString& source, const QString& path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_6_0);
+    if (!readHeader(in, source))
+        return false;
+
+    qint32 authors = 0;
+    in >> authors;
+    if (in.status() != QDataStream::Ok || authors < 0 || authors > f.size())
+        return false;
+
+    // Strings are read before the model is touched, so a damaged snapshot
+    // leaves the current document alone.
+    QVector<QString> names(authors);
+    for (QString& name : names)
+        in >> name;
+    qint32 rows = 0;
+    in >> rows;
+    if (in.status() != QDataStream::Ok || rows < 0 || rows > f.size())
+        return false;
+
+    struct Row { QString name; qint32 author; QString pages; };
+    QVector<Row> data(rows);
+    for (Row& row : data)
+        in >> row.name >> row.author >> row.pages;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    model->beginLoad();
+    QVector<int> ids(authors);
+    for (int i = 0; i < authors; ++i)
+        ids[i] = model->authors().intern(names[i]);
+    const int empty = model->authors().intern(QString());
+    for (const Row& row : data)
+        model->appendRow(model->makeRow(row.name, row.author >= 0 && row.author < authors ? ids[row.author] : empty,
+                                        row.pages));
+    model->endLoad();
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+
+#include <QString>
+
+#include "catalogmodel.h"
+
+// A binary copy of the loaded catalog kept in the cache directory, so the
+// last file can be reopened at startup without parsing it. The snapshot
+// records the source's path, size and modification time and is ignored as
+// soon as any of them differ. Authors are stored once and referenced by
+// index, so loading interns each distinct author a single time.
+class SessionSnapshot
+{
+public:
+    static QString defaultPath();
+
+    static bool isFresh(const QString& source, const QString& path);
+    static bool save(const CatalogModel* model, const QString& source, const QString& path);
+    static bool load(CatalogModel* model, const QString& source, const QString& path);
+};
+
+#endif // SESSIONSNAPSHOT_H
@@ -0,0 +1,121 @@
+#include "statspanel.h"
+
+AuthorStatsModel::AuthorStatsModel(CatalogModel* catalog, CatalogStats* stats, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_catalog(catalog)
+    , m_stats(stats)
+    , m_rows(stats->authorCount())
+{
+    connect(m_stats, &CatalogStats::authorChanged, this, &AuthorStatsModel::onAuthorChanged);
+    connect(m_stats, &CatalogStats::reset,         this, &AuthorStatsModel::onReset);
+}
+
+int AuthorStatsModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+int AuthorStatsModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant AuthorStatsModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    const CatalogStats::Aggregate& a = m_stats->author(index.row());
+    switch (index.column())
+    {
+        case AuthorColumn:  return m_catalog->authors().name(index.row());
+        case BooksColumn:   return a.books;
+        case PagesColumn:   return a.pages;
+        case AverageColumn: return QString::number(a.average(), 'f', 1);
+        case MinColumn:     return a.minPages();
+        case MaxColumn:     return a.maxPages();
+        default:            return QVariant();
+    }
+}
+
+QVariant AuthorStatsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (section)
+    {
+        case AuthorColumn:  return tr("Author");
+        case BooksColumn:   return tr("Books");
+        case PagesColumn:   return tr("Pages");
+        case AverageColumn: return tr("Avg");
+        case MinColumn:     return tr("Min");
+        case MaxColumn:     return tr("Max");
+        default:            return QVariant();
+    }
+}
+
+void AuthorStatsModel::onAuthorChanged(int id)
+{
+    if (id >= m_rows)
+    {
+        beginInsertRows(QModelIndex(), m_rows, id);
+        m_rows = id + 1;
+        endInsertRows();
+        return;
+    }
+    emit dataChanged(index(id, 0), index(id, ColumnCount - 1));
+}
+
+void AuthorStatsModel::onReset()
+{
+    beginResetModel();
+    m_rows = m_stats->authorCount();
+    endResetModel();
+}
+
+// ------------------------------------------------------------
+
+StatsPanel::StatsPanel(CatalogModel* catalog, CatalogStats* stats, QWidget* parent)
+    : QWidget(parent)
+    , m_stats(stats)
+{
+    m_model = new AuthorStatsModel(catalog, stats, this);
+
+    m_proxy = new QSortFilterProxyModel(this);
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setFilterKeyColumn(AuthorStatsModel::BooksColumn);
+    m_proxy->setFilterRegularExpression(QRegularExpression("^[1-9]"));
+    m_proxy->setSortRole(Qt::DisplayRole);
+
+    m_table = new QTableView(this);
+    m_table->setModel(m_proxy);
+    m_table->setSortingEnabled(true);
+    m_table->sortByColumn(AuthorStatsModel::BooksColumn, Qt::DescendingOrder);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setSectionResizeMode(AuthorStatsModel::AuthorColumn, QHeaderView::Stretch);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    m_totals = new QLabel(this);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(m_totals);
+    layout->addWidget(m_table, 1);
+    setLayout(layout);
+
+    connect(m_stats, &CatalogStats::totalChanged, this, &StatsPanel::updateTotals);
+    connect(m_stats, &CatalogStats::reset,        this, &StatsPanel::updateTotals);
+    updateTotals();
+}
+
+void StatsPanel::updateTotals()
+{
+    const CatalogStats::Aggregate& t = m_stats->total();
+    m_totals->setText(tr("Books: %1   Pages: %2   Avg: %3   Min: %4   Max: %5")
+                          .arg(t.books)
+                          .arg(t.pages)
+                          .arg(t.average(), 0, 'f', 1)
+                          .arg(t.minPages())
+                          .arg(t.maxPages()));
+}
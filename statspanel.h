@@ -0,0 +1,56 @@
+#ifndef STATSPANEL_H
+#define STATSPANEL_H
+
+#include <QWidget>
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <QTableView>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QRegularExpression>
+
+#include "catalogstats.h"
+
+// One row per pooled author id; authors without books are hidden by the panel.
+class AuthorStatsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { AuthorColumn, BooksColumn, PagesColumn, AverageColumn, MinColumn, MaxColumn, ColumnCount };
+
+    AuthorStatsModel(CatalogModel* catalog, CatalogStats* stats, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    void onAuthorChanged(int id);
+    void onReset();
+
+    CatalogModel*   m_catalog;
+    CatalogStats*   m_stats;
+    int             m_rows = 0;
+};
+
+class StatsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    StatsPanel(CatalogModel* catalog, CatalogStats* stats, QWidget* parent = nullptr);
+
+private:
+    void updateTotals();
+
+    CatalogStats*           m_stats;
+    AuthorStatsModel*       m_model   = nullptr;
+    QSortFilterProxyModel*  m_proxy   = nullptr;
+    QTableView*             m_table   = nullptr;
+    QLabel*                 m_totals  = nullptr;
+};
+
+#endif // STATSPANEL_H
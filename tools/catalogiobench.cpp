@@ -0,0 +1,269 @@
+// Compares reading and writing a catalog through QTextStream with the
+// byte-level CatalogReader and CatalogWriter, on an in-memory buffer, and
+// checks that both produce the same rows and the same bytes. Then times a
+// save and an open of a real file the way the application does them:
+// CompressedDevice, the model built line by line, batches validated on the
+// thread pool, and the rows written back from a snapshot.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QBuffer>
+#include <QTextStream>
+#include <QTemporaryDir>
+#include <QFileInfo>
+
+#include "catalogio.h"
+#include "catalogmodel.h"
+#include "catalogschema.h"
+#include "compresseddevice.h"
+
+namespace {
+
+struct Row
+{
+    QString name;
+    QString author;
+    QString pages;
+};
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+double megabytesPerSecond(qint64 bytes, qint64 ms)
+{
+    return ms > 0 ? bytes / 1048.576 / ms : 0.0;
+}
+
+QString word(QRandomGenerator& random, bool cyrillic)
+{
+    const int length = 3 + random.bounded(9);
+    QString s;
+    s.reserve(length);
+    for (int i = 0; i < length; ++i)
+        s += cyrillic ? QChar(0x0430 + random.bounded(32)) : QChar('a' + random.bounded(26));
+    s[0] = s[0].toUpper();
+    return s;
+}
+
+QVector<Row> makeRows(int count, int cyrillicPercent)
+{
+    QRandomGenerator random(42);
+    QVector<Row> rows;
+    rows.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const bool cyrillic = int(random.bounded(100)) < cyrillicPercent;
+        rows.append({ word(random, false) + ' ' + word(random, cyrillic),
+                      word(random, cyrillic) + ", " + word(random, false),
+                      QString::number(1 + random.bounded(2000)) });
+    }
+    return rows;
+}
+
+QByteArray writeTextStream(const QVector<Row>& rows)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QTextStream stream(&buffer);
+    for (const Row& row : rows)
+        stream << row.name << '\t' << row.author << '\t' << row.pages << '\n';
+    stream.flush();
+    return data;
+}
+
+QByteArray writeCatalogWriter(const QVector<Row>& rows)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    CatalogWriter writer(&buffer);
+    for (const Row& row : rows)
+        writer.writeRow(row.name, row.author, row.pages);
+    writer.flush();
+    return data;
+}
+
+QStringList readTextStream(QByteArray data)
+{
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    QTextStream stream(&buffer);
+    QStringList lines;
+    while (!stream.atEnd())
+        lines << stream.readLine();
+    return lines;
+}
+
+QStringList readCatalogReader(QByteArray data, int* invalid)
+{
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    CatalogReader reader(&buffer);
+    QStringList lines;
+    QString line;
+    while (reader.readLine(&line))
+        lines << line;
+    *invalid = reader.invalidLines();
+    return lines;
+}
+
+// Same steps as MainWindow::saveToFile() and ContentWindow::write().
+bool saveFile(const QString& path, const CatalogStore::Snapshot& rows)
+{
+    CompressedDevice file(path);
+    if (!file.open(QFile::WriteOnly | QFile::Text))
+        return false;
+    CatalogWriter writer(&file);
+    for (int b = 0; b < rows.blockCount(); ++b)
+        for (const CatalogStore::Row& row : rows.block(b))
+            writer.writeRow(row.name, row.author, row.pages);
+    const bool written = writer.flush();
+    file.close();
+    return written && !file.failed();
+}
+
+// Same steps as MainWindow::openFile() and ContentWindow::read().
+bool openFile(const QString& path, CatalogModel& model, int* issues)
+{
+    const int BatchRows = 65536;
+
+    CompressedDevice file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    CatalogReader reader(&file);
+
+    QFuture<QVector<CatalogSchema::Issue>> validation;
+    QStringList lines;
+    QVector<int> lineNumbers;
+    int rows = 0;
+    *issues = 0;
+    const auto validate = [&]() {
+        if (validation.isValid())
+            *issues += validation.result().size();
+        validation = CatalogSchema::validateLines(lines, lineNumbers, rows - int(lines.size()));
+        lines = QStringList();
+        lineNumbers = QVector<int>();
+    };
+
+    model.beginLoad();
+    QString line;
+    for (int lineNo = 1; reader.readLine(&line); ++lineNo)
+    {
+        if (line.isEmpty()) continue;
+        QStringList fields = line.split('\t');
+        while (fields.size() < CatalogModel::ColumnCount)
+            fields << QString();
+        model.appendRow(model.makeRow(fields[CatalogModel::NameColumn],
+                                      fields[CatalogModel::AuthorColumn],
+                                      fields[CatalogModel::PagesColumn]));
+        lines << line;
+        lineNumbers << lineNo;
+        if (++rows % BatchRows == 0)
+            validate();
+    }
+    model.endLoad();
+    if (!lines.isEmpty())
+        validate();
+    if (validation.isValid())
+        *issues += validation.result().size();
+    file.close();
+    return !file.failed();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Catalog text I/O benchmark.");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "rows",     "Rows to generate.",                     "n", "500000" },
+        { "cyrillic", "Percent of rows with Cyrillic words.",  "n", "10" },
+        { "suffix",   "File suffix for the open/save pass (.gz, .zst).", "suffix", "" },
+    });
+    parser.process(app);
+
+    const int count    = qMax(0, parser.value("rows").toInt());
+    const int cyrillic = qBound(0, parser.value("cyrillic").toInt(), 100);
+    const QVector<Row> rows = makeRows(count, cyrillic);
+
+    QElapsedTimer timer;
+    timer.start();
+    const QByteArray streamBytes = writeTextStream(rows);
+    const qint64 streamWrite = timer.restart();
+    const QByteArray writerBytes = writeCatalogWriter(rows);
+    const qint64 writerWrite = timer.restart();
+
+    const QStringList streamLines = readTextStream(writerBytes);
+    const qint64 streamRead = timer.restart();
+    int invalid = 0;
+    const QStringList readerLines = readCatalogReader(writerBytes, &invalid);
+    const qint64 readerRead = timer.restart();
+
+    const qint64 size = writerBytes.size();
+    out() << count << " rows, " << size << " bytes, " << cyrillic << "% Cyrillic" << Qt::endl;
+    out() << QString("write  QTextStream %1 MB/s, CatalogWriter %2 MB/s (%3x)")
+                 .arg(megabytesPerSecond(size, streamWrite), 0, 'f', 1)
+                 .arg(megabytesPerSecond(size, writerWrite), 0, 'f', 1)
+                 .arg(writerWrite > 0 ? double(streamWrite) / writerWrite : 0.0, 0, 'f', 2) << Qt::endl;
+    out() << QString("read   QTextStream %1 MB/s, CatalogReader %2 MB/s (%3x)")
+                 .arg(megabytesPerSecond(size, streamRead), 0, 'f', 1)
+                 .arg(megabytesPerSecond(size, readerRead), 0, 'f', 1)
+                 .arg(readerRead > 0 ? double(streamRead) / readerRead : 0.0, 0, 'f', 2) << Qt::endl;
+
+    // End to end on disk: save the rows from a model, open them into another.
+    QTemporaryDir dir;
+    const QString path = dir.filePath("catalog.txt" + parser.value("suffix"));
+    CatalogModel source;
+    source.beginLoad();
+    for (const Row& row : rows)
+        source.appendRow(source.makeRow(row.name, row.author, row.pages));
+    source.endLoad();
+
+    bool ok = true;
+    timer.restart();
+    if (!saveFile(path, source.snapshot()))
+    {
+        out() << "Cannot save " << path << Qt::endl;
+        return 1;
+    }
+    const qint64 saved = timer.restart();
+    CatalogModel loaded;
+    int issues = 0;
+    if (!openFile(path, loaded, &issues))
+    {
+        out() << "Cannot open " << path << Qt::endl;
+        return 1;
+    }
+    const qint64 opened = timer.restart();
+    out() << QString("file   save %1 MB/s (%2 ms), open %3 MB/s (%4 ms), %5 bytes on disk")
+                 .arg(megabytesPerSecond(size, saved), 0, 'f', 1).arg(saved)
+                 .arg(megabytesPerSecond(size, opened), 0, 'f', 1).arg(opened)
+                 .arg(QFileInfo(path).size()) << Qt::endl;
+    if (loaded.rowCount() != count || issues != 0)
+    {
+        out() << "Opened " << loaded.rowCount() << " rows with " << issues << " problems." << Qt::endl;
+        ok = false;
+    }
+
+    if (streamBytes != writerBytes)
+    {
+        out() << "Written bytes differ." << Qt::endl;
+        ok = false;
+    }
+    if (streamLines != readerLines || invalid != 0)
+    {
+        out() << "Read lines differ." << Qt::endl;
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
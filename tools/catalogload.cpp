@@ -0,0 +1,148 @@
+// Load generator for the catalog server: appends rows in pipelined batches,
+// then runs queries and lookups against them and prints the throughput.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "catalogclient.h"
+
+using CatalogProtocol::Row;
+
+namespace {
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+double perSecond(qint64 n, qint64 ms)
+{
+    return ms > 0 ? n * 1000.0 / ms : double(n);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Load test for the catalog server.");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "server",  "Server name.",                         "name",  QString::fromLatin1(CatalogProtocol::DefaultServerName) },
+        { "rows",    "Rows to insert.",                      "n",     "100000" },
+        { "batch",   "Rows per insert request.",             "n",     "500" },
+        { "window",  "Requests in flight.",                  "n",     "16" },
+        { "queries", "Queries and lookups to run after it.", "n",     "200" },
+    });
+    parser.process(app);
+
+    const int rows    = qMax(0, parser.value("rows").toInt());
+    const int batch   = qMax(1, parser.value("batch").toInt());
+    const int window  = qMax(1, parser.value("window").toInt());
+    const int queries = qMax(0, parser.value("queries").toInt());
+
+    CatalogClient client;
+    if (!client.connectToServer(parser.value("server")))
+    {
+        out() << "Cannot connect: " << client.errorString() << Qt::endl;
+        return 1;
+    }
+
+    CatalogClient::Reply reply;
+    quint32 id = client.count();
+    if (!client.waitForReply(id) || !client.takeReply(id, &reply) || !reply.ok)
+    {
+        out() << "Count failed: " << (reply.error.isEmpty() ? client.errorString() : reply.error) << Qt::endl;
+        return 1;
+    }
+    const qint32 before = reply.value;
+
+    // Inserts, keeping up to window requests in flight.
+    QElapsedTimer timer;
+    timer.start();
+    QVector<quint32> inFlight;
+    QRandomGenerator* random = QRandomGenerator::global();
+    int sent = 0;
+    int failed = 0;
+    auto settle = [&](int keep) {
+        while (inFlight.size() > keep)
+        {
+            const quint32 first = inFlight.takeFirst();
+            if (!client.waitForReply(first) || !client.takeReply(first, &reply) || !reply.ok)
+                ++failed;
+        }
+    };
+    while (sent < rows)
+    {
+        QVector<Row> block;
+        const int n = qMin(batch, rows - sent);
+        block.reserve(n);
+        for (int i = 0; i < n; ++i)
+        {
+            const int k = sent + i;
+            block.append({ QStringLiteral("Load title %1").arg(k),
+                           QStringLiteral("Author %1").arg(random->bounded(1000)),
+                           QString::number(1 + random->bounded(2000)) });
+        }
+        inFlight.append(client.insert(block));
+        sent += n;
+        if (inFlight.size() >= window)
+        {
+            client.flush();
+            settle(window / 2);
+        }
+    }
+    settle(0);
+    const qint64 insertMs = timer.elapsed();
+    out() << "Inserted " << sent << " rows in " << insertMs << " ms ("
+          << qRound64(perSecond(sent, insertMs)) << " rows/s, " << failed << " failed requests)" << Qt::endl;
+
+    // Queries.
+    timer.restart();
+    qint64 matched = 0;
+    for (int i = 0; i < queries; ++i)
+    {
+        inFlight.append(client.query(QStringLiteral("Author %1").arg(random->bounded(1000)), 50));
+        if (inFlight.size() >= window)
+        {
+            for (quint32 q : inFlight)
+                if (client.waitForReply(q) && client.takeReply(q, &reply) && reply.ok)
+                    matched += reply.value;
+            inFlight.clear();
+        }
+    }
+    for (quint32 q : inFlight)
+        if (client.waitForReply(q) && client.takeReply(q, &reply) && reply.ok)
+            matched += reply.value;
+    inFlight.clear();
+    const qint64 queryMs = timer.elapsed();
+    out() << "Ran " << queries << " queries in " << queryMs << " ms ("
+          << perSecond(queries, queryMs) << " queries/s, " << matched << " matches)" << Qt::endl;
+
+    // Lookups of random rows.
+    timer.restart();
+    const qint32 total = before + sent;
+    qint64 fetched = 0;
+    for (int i = 0; i < queries && total > 0; ++i)
+    {
+        QVector<qint32> wanted(100);
+        for (qint32& row : wanted)
+            row = random->bounded(total);
+        inFlight.append(client.lookup(wanted));
+    }
+    for (quint32 q : inFlight)
+        if (client.waitForReply(q) && client.takeReply(q, &reply) && reply.ok)
+            fetched += reply.rows.size();
+    const qint64 lookupMs = timer.elapsed();
+    out() << "Fetched " << fetched << " rows by number in " << lookupMs << " ms ("
+          << qRound64(perSecond(fetched, lookupMs)) << " rows/s)" << Qt::endl;
+
+    client.disconnectFromServer();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+// Times fuzzy search over a generated catalog: the initial scan and ranking,
+// then how long single edits, inserts and removals take to re-filter and
+// re-sort while the fuzzy view stays open.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "catalogmodel.h"
+#include "catalogproxymodel.h"
+
+namespace {
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QString word(QRandomGenerator& random)
+{
+    static const char* const syllables[] = { "ka", "to", "ri", "len", "mi", "sto", "ev", "ol", "an", "dr" };
+    QString s;
+    const int n = 2 + random.bounded(3);
+    for (int i = 0; i < n; ++i)
+        s += QLatin1String(syllables[random.bounded(10)]);
+    s[0] = s[0].toUpper();
+    return s;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Fuzzy search benchmark.");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "rows",     "Rows to generate.",          "n",    "1000000" },
+        { "authors",  "Distinct authors.",          "n",    "20000" },
+        { "pattern",  "Search text.",               "text", "tolstoj" },
+        { "distance", "Edits tolerated.",           "n",    "1" },
+        { "edits",    "Edits, inserts and removals to time.", "n", "200" },
+    });
+    parser.process(app);
+
+    const int rows     = qMax(1, parser.value("rows").toInt());
+    const int authors  = qMax(1, parser.value("authors").toInt());
+    const int distance = qBound(0, parser.value("distance").toInt(), 3);
+    const int edits    = qMax(1, parser.value("edits").toInt());
+
+    QRandomGenerator random(42);
+    QStringList names;
+    for (int i = 0; i < authors; ++i)
+        names << word(random) + ' ' + word(random);
+    names[0] = "Lev Tolstoy";
+
+    CatalogModel model;
+    QElapsedTimer timer;
+    timer.start();
+    QVector<QList<QStandardItem*>> batch;
+    batch.reserve(rows);
+    for (int r = 0; r < rows; ++r)
+        batch.append(model.makeRow(word(random) + ' ' + word(random),
+                                   names[random.bounded(authors)],
+                                   QString::number(1 + random.bounded(2000))));
+    model.appendRows(batch);
+    out() << rows << " rows built in " << timer.restart() << " ms" << Qt::endl;
+
+    CatalogProxyModel proxy;
+    proxy.setCatalog(&model);
+    proxy.setSearchText(parser.value("pattern"));
+    timer.restart();
+    proxy.setFuzzy(true, distance);
+    out() << "scan, filter and rank: " << timer.restart() << " ms, "
+          << proxy.rowCount() << " rows kept" << Qt::endl;
+
+    for (int i = 0; i < edits; ++i)
+    {
+        const int r = random.bounded(model.rowCount());
+        model.setData(model.index(r, CatalogModel::NameColumn), word(random) + " Tolstoj");
+    }
+    const qint64 edited = timer.restart();
+
+    for (int i = 0; i < edits; ++i)
+    {
+        QVector<QList<QStandardItem*>> one;
+        one.append(model.makeRow("Anna " + word(random), names[0], "800"));
+        model.appendRows(one);
+    }
+    const qint64 inserted = timer.restart();
+
+    for (int i = 0; i < edits; ++i)
+        model.removeRow(random.bounded(model.rowCount()));
+    const qint64 removed = timer.restart();
+
+    out() << QString("per edit %1 ms, per insert %2 ms, per removal %3 ms")
+                 .arg(double(edited) / edits, 0, 'f', 3)
+                 .arg(double(inserted) / edits, 0, 'f', 3)
+                 .arg(double(removed) / edits, 0, 'f', 3) << Qt::endl;
+    out() << proxy.rowCount() << " rows kept at the end" << Qt::endl;
+    return 0;
+}
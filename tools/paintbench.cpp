@@ -0,0 +1,119 @@
+// Paints a scrolling table window into an offscreen image, once with
+// QStyledItemDelegate and once with CachedTextDelegate, and prints the
+// time per cell for each.
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStandardItemModel>
+#include <QStyledItemDelegate>
+#include <QPainter>
+#include <QImage>
+#include <QTextStream>
+
+#include "cachedtextdelegate.h"
+
+namespace {
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QString word(QRandomGenerator& random)
+{
+    static const char* const syllables[] = { "ka", "to", "ri", "len", "mi", "sto", "ev", "ol", "an", "dr" };
+    QString s;
+    const int n = 2 + random.bounded(4);
+    for (int i = 0; i < n; ++i)
+        s += QLatin1String(syllables[random.bounded(10)]);
+    s[0] = s[0].toUpper();
+    return s;
+}
+
+// Paints `frames` windows of `visible` rows, moving down one row per frame
+// as a scrolling view would, and returns nanoseconds per cell.
+double paintFrames(const QStandardItemModel& model, QStyledItemDelegate* delegates[], QImage& image,
+                   int visible, int frames)
+{
+    const int columns = model.columnCount();
+    const int width   = image.width() / columns;
+    const int height  = image.height() / visible;
+
+    QStyleOptionViewItem option;
+    option.font        = QApplication::font();
+    option.fontMetrics = QFontMetrics(option.font);
+    option.palette     = QApplication::palette();
+    option.state       = QStyle::State_Enabled | QStyle::State_Active;
+
+    QPainter painter(&image);
+    QElapsedTimer timer;
+    timer.start();
+    qint64 cells = 0;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        const int top = frame % qMax(1, model.rowCount() - visible);
+        painter.fillRect(image.rect(), Qt::white);
+        for (int r = 0; r < visible; ++r)
+            for (int c = 0; c < columns; ++c)
+            {
+                option.rect  = QRect(c * width, r * height, width, height);
+                option.index = model.index(top + r, c);
+                delegates[c]->paint(&painter, option, option.index);
+                ++cells;
+            }
+    }
+    return cells > 0 ? double(timer.nsecsElapsed()) / cells : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Table cell painting benchmark.");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "rows",    "Rows in the model.",        "n", "100000" },
+        { "visible", "Rows painted per frame.",   "n", "40" },
+        { "frames",  "Frames to paint.",          "n", "2000" },
+    });
+    parser.process(app);
+
+    const int rows    = qMax(1, parser.value("rows").toInt());
+    const int visible = qBound(1, parser.value("visible").toInt(), rows);
+    const int frames  = qMax(1, parser.value("frames").toInt());
+
+    QRandomGenerator random(42);
+    QStandardItemModel model(rows, 3);
+    for (int r = 0; r < rows; ++r)
+    {
+        model.setItem(r, 0, new QStandardItem(word(random) + ' ' + word(random)));
+        model.setItem(r, 1, new QStandardItem(word(random) + ", " + word(random)));
+        model.setItem(r, 2, new QStandardItem(QString::number(1 + random.bounded(2000))));
+    }
+
+    QImage image(900, visible * 24, QImage::Format_ARGB32_Premultiplied);
+
+    QStyledItemDelegate styled;
+    QStyledItemDelegate* plain[] = { &styled, &styled, &styled };
+    const double before = paintFrames(model, plain, image, visible, frames);
+
+    CachedTextDelegate text;
+    CachedTextDelegate pages;
+    pages.setNumeric(true);
+    QStyledItemDelegate* cached[] = { &text, &text, &pages };
+    const double after = paintFrames(model, cached, image, visible, frames);
+
+    out() << QString("QStyledItemDelegate %1 ns per cell, CachedTextDelegate %2 ns per cell (%3x)")
+                 .arg(before, 0, 'f', 0)
+                 .arg(after, 0, 'f', 0)
+                 .arg(after > 0 ? before / after : 0.0, 0, 'f', 2) << Qt::endl;
+    return 0;
+}
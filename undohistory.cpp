@@ -0,0 +1,493 @@
+#include "undohistory.h"
+#include "celleditcommand.h"
+#include "addremoverows.h"
+#include "loghandler.h"
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtEndian>
+
+UndoHistory::UndoHistory(QUndoStack* stack, CatalogModel* model, QObject* parent)
+    : QObject(parent)
+    , m_stack(stack)
+    , m_model(model)
+{
+    connect(m_stack, &QUndoStack::indexChanged, this, &UndoHistory::onIndexChanged);
+}
+
+QString UndoHistory::pathFor(const QString& catalog)
+{
+    return catalog + ".history";
+}
+
+void UndoHistory::reset()
+{
+    m_older.clear();
+    ++m_generation;
+}
+
+HistoryCommand* UndoHistory::commandAt(int i) const
+{
+    // Everything ContentWindow pushes is a HistoryCommand.
+    return const_cast<HistoryCommand*>(static_cast<const HistoryCommand*>(m_stack->command(i)));
+}
+
+QByteArray UndoHistory::encode(const HistoryCommand* command)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint8(command->type());
+    command->write(out);
+    return payload;
+}
+
+HistoryCommand* UndoHistory::decode(const QByteArray& payload) const
+{
+    if (payload.isEmpty()) return nullptr;
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint8 type = 0;
+    in >> type;
+
+    HistoryCommand* command = nullptr;
+    switch (type)
+    {
+        case HistoryCommand::CellEdit:   command = CellEditCommand::read(in, m_model);   break;
+        case HistoryCommand::BatchEdit:  command = BatchEditCommand::read(in, m_model);  break;
+        case HistoryCommand::AddRow:     command = AddRowCommand::read(in, m_model);     break;
+        case HistoryCommand::RemoveRows: command = RemoveRowsCommand::read(in, m_model); break;
+        default: break;
+    }
+    if (in.status() != QDataStream::Ok)
+    {
+        delete command;
+        return nullptr;
+    }
+    return command;
+}
+
+QByteArray UndoHistory::frame(const QByteArray& payload)
+{
+    const quint32 size = qToBigEndian(quint32(payload.size()));
+    QByteArray record(reinterpret_cast<const char*>(&size), sizeof(size));
+    record += payload;
+    return record;
+}
+
+QByteArray UndoHistory::readRecord(QFile& file, const Entry& entry)
+{
+    if (!file.seek(entry.offset)) return QByteArray();
+    const QByteArray record = file.read(entry.size);
+    if (record.size() != entry.size || qFromBigEndian<quint32>(record.constData()) != quint32(entry.size - 4))
+        return QByteArray();
+    return record.mid(4);
+}
+
+bool UndoHistory::readTrailer(QFile& file, Trailer* trailer)
+{
+    const qint64 size = file.size();
+    if (readTrailerAt(file, size, trailer))
+        return true;
+
+    // An append that was cut short leaves a partial batch at the end; the
+    // footer before it still describes a complete history.
+    if (!file.seek(0)) return false;
+    const QByteArray data = file.readAll();
+    const quint32 magic = qToBigEndian(Magic);
+    const QByteArray pattern(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    for (qsizetype at = data.lastIndexOf(pattern, size - 5); at >= HeaderSize + 8;
+         at = data.lastIndexOf(pattern, at - 1))
+    {
+        if (readTrailerAt(file, at + 4, trailer))
+        {
+            qDebug(logWarning()) << "Undo history" << file.fileName() << "ends in an incomplete save; using the one before.";
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UndoHistory::readTrailerAt(QFile& file, qint64 end, Trailer* trailer)
+{
+    if (end < HeaderSize + FooterSize) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    file.seek(0);
+    in >> magic >> version;
+    if (magic != Magic || version != Version) return false;
+
+    qint64 start = 0;
+    file.seek(end - FooterSize);
+    in >> start >> magic;
+    if (in.status() != QDataStream::Ok || magic != Magic || start < HeaderSize || start > end - FooterSize)
+        return false;
+
+    qint32 n = 0;
+    file.seek(start);
+    in >> trailer->catalogSize >> trailer->catalogModified >> trailer->index >> n;
+    if (in.status() != QDataStream::Ok || n < 0 || qint64(n) * 12 > end - start
+        || trailer->index < 0 || trailer->index > n)
+        return false;
+
+    trailer->entries.resize(n);
+    for (Entry& e : trailer->entries)
+    {
+        in >> e.offset >> e.size;
+        if (e.offset < HeaderSize || e.size <= 4 || e.offset + e.size > start)
+            return false;
+    }
+    trailer->start = start;
+    return in.status() == QDataStream::Ok && file.pos() == end - FooterSize;
+}
+
+void UndoHistory::writeTrailer(QIODevice& device, const Trailer& trailer)
+{
+    QDataStream out(&device);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << trailer.catalogSize << trailer.catalogModified << trailer.index << qint32(trailer.entries.size());
+    for (const Entry& e : trailer.entries)
+        out << e.offset << e.size;
+    out << trailer.start << Magic;
+}
+
+// Replaces the stack's contents without touching the model, which already
+// reflects every command up to index.
+void UndoHistory::rebuild(const QVector<HistoryCommand*>& commands, int index)
+{
+    m_rebuilding = true;
+    ++m_generation;
+    for (HistoryCommand* command : commands)
+        command->setMuted(true);
+    m_stack->clear();
+    for (HistoryCommand* command : commands)
+        m_stack->push(command);
+    m_stack->setIndex(index);
+    for (HistoryCommand* command : commands)
+        command->setMuted(false);
+    m_rebuilding = false;
+}
+
+bool UndoHistory::load(const QString& catalog)
+{
+    m_stack->clear();
+    reset();
+    m_path = pathFor(catalog);
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    Trailer trailer;
+    const QFileInfo fi(catalog);
+    if (!readTrailer(file, &trailer)
+        || trailer.catalogSize != fi.size()
+        || trailer.catalogModified != fi.lastModified().toMSecsSinceEpoch())
+    {
+        qDebug(logInfo()) << "Undo history" << m_path << "does not belong to this version of the catalog; ignored.";
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const int first = qMax(0, trailer.index - PageSize);
+    QVector<HistoryCommand*> commands;
+    for (int i = first; i < trailer.entries.size(); ++i)
+    {
+        HistoryCommand* command = decode(readRecord(file, trailer.entries[i]));
+        if (!command)
+        {
+            qDeleteAll(commands);
+            qDebug(logWarning()) << "Undo history" << m_path << "is damaged; ignored.";
+            return false;
+        }
+        command->setStored(trailer.entries[i].offset, trailer.entries[i].size);
+        commands << command;
+    }
+    rebuild(commands, trailer.index - first);
+    m_older = trailer.entries.mid(0, first);
+
+    qDebug(logInfo()) << "Undo history: read" << commands.size() << "of" << trailer.entries.size()
+                      << "steps in" << timer.elapsed() << "ms.";
+    return true;
+}
+
+void UndoHistory::onIndexChanged(int index)
+{
+    if (m_rebuilding) return;
+    if (m_stack->count() == 0)
+    {
+        m_older.clear();
+        ++m_generation;
+        return;
+    }
+    // Deferred, since the stack is still inside undo() here.
+    if (index < LowWater && !m_older.isEmpty() && !m_pagePending)
+    {
+        m_pagePending = true;
+        QTimer::singleShot(0, this, &UndoHistory::pageIn);
+    }
+}
+
+void UndoHistory::pageIn()
+{
+    m_pagePending = false;
+    if (m_older.isEmpty() || m_stack->count() == 0) return;
+
+    QElapsedTimer timer;
+    timer.start();
+    QFile file(m_path);
+    const int first = qMax(0, int(m_older.size()) - PageSize);
+    QVector<HistoryCommand*> commands;
+    bool ok = file.open(QIODevice::ReadOnly);
+    for (int i = first; ok && i < m_older.size(); ++i)
+    {
+        HistoryCommand* command = decode(readRecord(file, m_older[i]));
+        ok = command != nullptr;
+        if (ok)
+        {
+            command->setStored(m_older[i].offset, m_older[i].size);
+            commands << command;
+        }
+    }
+    if (!ok)
+    {
+        qDeleteAll(commands);
+        qDebug(logWarning()) << "Couldn't read older undo steps from" << m_path;
+        m_older.clear();
+        return;
+    }
+
+    // QUndoStack can neither take commands below its bottom nor hand over
+    // the ones it owns, so those are re-created from their encoding.
+    const int older = commands.size();
+    for (int i = 0; i < m_stack->count(); ++i)
+    {
+        const HistoryCommand* current = commandAt(i);
+        HistoryCommand* copy = decode(encode(current));
+        if (!copy)
+        {
+            qDeleteAll(commands);
+            qDebug(logWarning()) << "Couldn't re-create undo step" << i << "while paging in older ones.";
+            m_older.clear();
+            return;
+        }
+        copy->setStored(current->storedAt(), current->storedSize());
+        commands << copy;
+    }
+    const int index = older + m_stack->index();
+    m_older.resize(first);
+    rebuild(commands, index);
+
+    qDebug(logDebug()) << "Undo history: paged in" << older << "older steps in" << timer.elapsed() << "ms.";
+}
+
+UndoHistory::SavePlan UndoHistory::prepareSave(const QString& catalog) const
+{
+    SavePlan plan;
+    plan.catalog    = catalog;
+    plan.path       = pathFor(catalog);
+    plan.source     = m_path;
+    plan.stackCount = m_stack->count();
+    plan.stackIndex = m_stack->index();
+    plan.generation = m_generation;
+
+    // Older entries come first and have no command; the stack's follow.
+    QVector<SavePlan::Item>& items = plan.items;
+    for (const Entry& e : m_older)
+        items.append({ e, QByteArray(), nullptr });
+    for (int i = 0; i < m_stack->count(); ++i)
+    {
+        HistoryCommand* command = commandAt(i);
+        SavePlan::Item item{ Entry{ command->storedAt(), command->storedSize() }, QByteArray(), command };
+        if (command->storedAt() < 0)
+        {
+            item.payload = encode(command);
+            item.stored.size = 4 + int(item.payload.size());
+        }
+        items.append(item);
+    }
+    int index = m_older.size() + m_stack->index();
+
+    // Applied steps go from the bottom first. Steps still to be redone can
+    // only be cut from the top, or the rest would not start from the
+    // current state.
+    qint64 live = 0;
+    for (const SavePlan::Item& item : items)
+        live += item.stored.size;
+    int drop = 0;
+    while (drop < index && (items.size() - drop > MaxEntries || live > MaxBytes))
+        live -= items[drop++].stored.size;
+    items.remove(0, drop);
+    index -= drop;
+    while (items.size() > index && (items.size() > MaxEntries || live > MaxBytes))
+    {
+        live -= items.last().stored.size;
+        items.removeLast();
+    }
+    plan.index = index;
+    return plan;
+}
+
+// Touches nothing but files, so it can run with the catalog save.
+void UndoHistory::write(SavePlan& plan)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    Trailer trailer;
+    const QFileInfo fi(plan.catalog);
+    trailer.catalogSize     = fi.size();
+    trailer.catalogModified = fi.lastModified().toMSecsSinceEpoch();
+    trailer.index           = plan.index;
+
+    QFile file(plan.path);
+    Trailer old;
+    const bool append = plan.path == plan.source && file.open(QIODevice::ReadWrite) && readTrailer(file, &old);
+    const qint64 end = append ? file.size() : 0;
+
+    qint64 live = 0, fresh = 0;
+    for (const SavePlan::Item& item : plan.items)
+    {
+        live += item.stored.size;
+        if (!item.payload.isNull())
+            fresh += item.stored.size;
+    }
+    plan.rewritten = !append || (end - HeaderSize) + fresh > 2 * live + CompactSlack;
+
+    if (plan.rewritten)
+    {
+        // Stored records are copied from the file their offsets refer to.
+        QFile source(plan.source);
+        if (!append && !plan.source.isEmpty())
+            source.open(QIODevice::ReadOnly);
+        QFile& from = append ? file : source;
+
+        QByteArray data;
+        {
+            QDataStream out(&data, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_6_0);
+            out << Magic << Version;
+        }
+        for (SavePlan::Item& item : plan.items)
+        {
+            QByteArray payload = item.payload;
+            if (payload.isNull())
+                payload = readRecord(from, item.stored);
+            if (payload.isEmpty())
+            {
+                qDebug(logWarning()) << "Undo history: a stored step could not be read; history not saved.";
+                plan.damaged = true;
+                return;
+            }
+            item.stored.offset = data.size();
+            item.stored.size   = 4 + int(payload.size());
+            data += frame(payload);
+        }
+        file.close();
+        source.close();
+
+        QSaveFile out(plan.path);
+        if (!out.open(QIODevice::WriteOnly))
+        {
+            qDebug(logWarning()) << "Cannot write undo history" << plan.path << ":" << out.errorString();
+            return;
+        }
+        out.write(data);
+        for (const SavePlan::Item& item : plan.items)
+            trailer.entries << item.stored;
+        trailer.start = data.size();
+        writeTrailer(out, trailer);
+        if (!out.commit())
+        {
+            qDebug(logWarning()) << "Cannot write undo history" << plan.path << ":" << out.errorString();
+            return;
+        }
+    }
+    else
+    {
+        // New records, table and footer go after the old footer, which
+        // stays the valid end of the file until the new one is complete. A
+        // failed write is cut back off.
+        QByteArray batch;
+        qint64 pos = end;
+        for (SavePlan::Item& item : plan.items)
+        {
+            if (item.payload.isNull()) continue;
+            item.stored.offset = pos;
+            batch += frame(item.payload);
+            pos += item.stored.size;
+        }
+        for (const SavePlan::Item& item : plan.items)
+            trailer.entries << item.stored;
+        trailer.start = pos;
+
+        bool ok = file.seek(end) && file.write(batch) == batch.size();
+        if (ok)
+        {
+            writeTrailer(file, trailer);
+            ok = file.flush() && file.error() == QFileDevice::NoError;
+        }
+        if (!ok)
+        {
+            qDebug(logWarning()) << "Cannot write undo history" << plan.path << ":" << file.errorString();
+            file.unsetError();
+            file.resize(end);
+            return;
+        }
+        file.close();
+    }
+
+    plan.ok = true;
+    qDebug(logInfo()) << "Undo history:" << plan.items.size() << "steps saved," << fresh << "new bytes"
+                      << (plan.rewritten ? "(rewritten)" : "(appended)") << "in" << timer.elapsed() << "ms.";
+}
+
+void UndoHistory::finishSave(const SavePlan& plan, bool current)
+{
+    // Commands not known to be in the file are encoded again next time.
+    for (int i = 0; i < m_stack->count(); ++i)
+        commandAt(i)->setStored(-1, 0);
+
+    const bool same = plan.generation == m_generation;
+    if (!plan.ok)
+    {
+        // Start over from memory next time.
+        if (plan.damaged && same)
+            m_older.clear();
+        return;
+    }
+
+    if (!same)
+    {
+        // The stack was replaced meanwhile. Appending moved nothing, but a
+        // rewrite left the older entries pointing into the old file.
+        if (plan.rewritten && m_path == plan.path)
+            m_older.clear();
+        return;
+    }
+
+    m_path = plan.path;
+    if (plan.rewritten || current)
+    {
+        // Steps cut off in the plan are no longer in the file.
+        m_older.clear();
+        for (const SavePlan::Item& item : plan.items)
+            if (!item.command)
+                m_older << item.stored;
+    }
+
+    // The commands are only known to match the plan when nothing was edited
+    // since it was taken.
+    if (!current || m_stack->count() != plan.stackCount || m_stack->index() != plan.stackIndex)
+        return;
+    for (const SavePlan::Item& item : plan.items)
+        if (item.command)
+            item.command->setStored(item.stored.offset, item.stored.size);
+}
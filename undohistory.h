@@ -0,0 +1,111 @@
+#ifndef UNDOHISTORY_H
+#define UNDOHISTORY_H
+
+#include <QObject>
+#include <QUndoStack>
+#include <QFile>
+#include <QVector>
+
+#include "catalogmodel.h"
+#include "historycommand.h"
+
+// Keeps a catalog's undo stack in a sidecar file next to it
+// (<catalog>.history), so edits can still be undone after a restart.
+//
+// The file is append-mostly: a save appends the commands that are not stored
+// yet in one batch after the previous footer, followed by a new table of
+// entries and footer, and only rewrites the file once dead bytes outweigh
+// live ones. Should a save be cut short, the last complete footer is used.
+// Opening reads the table and the newest PageSize entries below the current
+// position; older ones are read a page at a time as undo nears the bottom of
+// the stack. A history whose catalog no longer has the recorded size and
+// modification time is ignored. At most MaxEntries entries and MaxBytes are kept.
+class UndoHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry
+    {
+        qint64 offset = -1;
+        qint32 size   = 0;      // including the length prefix
+    };
+
+    // A save is taken from the stack by prepareSave() on the GUI thread,
+    // written by write() on any thread (after the catalog, whose size and
+    // time it records) and handed back to finishSave().
+    struct SavePlan
+    {
+        struct Item
+        {
+            Entry           stored;
+            QByteArray      payload;    // set when not stored yet
+            HistoryCommand* command = nullptr;
+        };
+
+        QString         catalog;
+        QString         path;
+        QString         source;         // file the stored entries are in
+        QVector<Item>   items;          // older entries first, then the stack's
+        int             index      = 0;
+        int             stackCount = 0;
+        int             stackIndex = 0;
+        int             generation = 0;
+        bool            ok         = false;
+        bool            rewritten  = false;
+        bool            damaged    = false;     // a stored entry was unreadable
+    };
+
+    UndoHistory(QUndoStack* stack, CatalogModel* model, QObject* parent = nullptr);
+
+    static QString pathFor(const QString& catalog);
+
+    bool load(const QString& catalog);
+    SavePlan prepareSave(const QString& catalog) const;
+    static void write(SavePlan& plan);
+    // current: nothing was edited while the plan was being written.
+    void finishSave(const SavePlan& plan, bool current);
+    void reset();
+
+private:
+    struct Trailer
+    {
+        qint64         catalogSize     = -1;
+        qint64         catalogModified = -1;
+        qint32         index           = 0;
+        QVector<Entry> entries;
+        qint64         start           = 0;
+    };
+
+    static constexpr quint32 Magic       = 0x4c424849;     // "LBHI"
+    static constexpr quint16 Version     = 1;
+    static constexpr int     HeaderSize  = 6;
+    static constexpr int     FooterSize  = 12;
+    static constexpr int     PageSize    = 64;
+    static constexpr int     LowWater    = 8;
+    static constexpr int     MaxEntries  = 2000;
+    static constexpr qint64  MaxBytes    = 32 << 20;
+    static constexpr qint64  CompactSlack = 1 << 20;
+
+    static bool readTrailer(QFile& file, Trailer* trailer);
+    static bool readTrailerAt(QFile& file, qint64 end, Trailer* trailer);
+    static void writeTrailer(QIODevice& out, const Trailer& trailer);
+    static QByteArray readRecord(QFile& file, const Entry& entry);
+    static QByteArray frame(const QByteArray& payload);
+    static QByteArray encode(const HistoryCommand* command);
+    HistoryCommand* decode(const QByteArray& payload) const;
+    HistoryCommand* commandAt(int i) const;
+    void rebuild(const QVector<HistoryCommand*>& commands, int index);
+    void onIndexChanged(int index);
+    void pageIn();
+
+    QUndoStack*     m_stack;
+    CatalogModel*   m_model;
+    QString         m_path;         // file the stored offsets refer to
+    QVector<Entry>  m_older;        // entries below the stack, oldest first
+    bool            m_rebuilding  = false;
+    bool            m_pagePending = false;
+    int             m_generation  = 0;      // bumped whenever m_older or the commands are replaced
+};
+
+#endif // UNDOHISTORY_H
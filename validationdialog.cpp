@@ -0,0 +1,90 @@
+#include "validationdialog.h"
+
+void IssueModel::setIssues(const QVector<CatalogSchema::Issue>& issues)
+{
+    beginResetModel();
+    m_issues = issues;
+    endResetModel();
+}
+
+int IssueModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_issues.size();
+}
+
+int IssueModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 3;
+}
+
+QVariant IssueModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    const CatalogSchema::Issue& is = m_issues[index.row()];
+    switch (index.column())
+    {
+        case 0:  return is.line > 0 ? QVariant(is.line) : QVariant(tr("row %1").arg(is.row + 1));
+        case 1:  return CatalogModel::columnName(is.column);
+        default: return CatalogSchema::describe(CatalogSchema::Problem(is.problem));
+    }
+}
+
+QVariant IssueModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+    switch (section)
+    {
+        case 0:  return tr("Line");
+        case 1:  return tr("Column");
+        default: return tr("Problem");
+    }
+}
+
+// ------------------------------------------------------------
+
+ValidationDialog::ValidationDialog(QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Validation report"));
+    resize(520, 360);
+
+    m_model = new IssueModel(this);
+
+    m_table = new QTableView(this);
+    m_table->setModel(m_model);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setStretchLastSection(true);
+
+    m_summary = new QLabel(this);
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_fix = buttons->addButton(tr("Fix all"), QDialogButtonBox::ActionRole);
+    QPushButton* recheck = buttons->addButton(tr("Revalidate"), QDialogButtonBox::ActionRole);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(m_summary);
+    layout->addWidget(m_table, 1);
+    layout->addWidget(buttons);
+    setLayout(layout);
+
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::close);
+    connect(m_fix,   &QPushButton::clicked, this, &ValidationDialog::fixRequested);
+    connect(recheck, &QPushButton::clicked, this, &ValidationDialog::revalidateRequested);
+    connect(m_table, &QTableView::activated, this, [this](const QModelIndex& idx) {
+        const CatalogSchema::Issue& is = m_model->issue(idx.row());
+        emit jumpRequested(is.row, is.column);
+    });
+}
+
+void ValidationDialog::setIssues(const QVector<CatalogSchema::Issue>& issues)
+{
+    m_model->setIssues(issues);
+    m_summary->setText(issues.isEmpty() ? tr("No problems found.")
+                                        : tr("%n problem(s) found. Double-click one to jump to it.", nullptr, issues.size()));
+    m_fix->setEnabled(!issues.isEmpty());
+}
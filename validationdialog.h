@@ -0,0 +1,55 @@
+#ifndef VALIDATIONDIALOG_H
+#define VALIDATIONDIALOG_H
+
+#include <QDialog>
+#include <QAbstractTableModel>
+#include <QTableView>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QVBoxLayout>
+#include <QHeaderView>
+
+#include "catalogschema.h"
+
+class IssueModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit IssueModel(QObject* parent = nullptr) : QAbstractTableModel(parent) {}
+
+    void setIssues(const QVector<CatalogSchema::Issue>& issues);
+    const CatalogSchema::Issue& issue(int row) const { return m_issues[row]; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<CatalogSchema::Issue> m_issues;
+};
+
+class ValidationDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ValidationDialog(QWidget* parent = nullptr);
+
+    void setIssues(const QVector<CatalogSchema::Issue>& issues);
+
+signals:
+    void jumpRequested(int row, int column);
+    void fixRequested();
+    void revalidateRequested();
+
+private:
+    IssueModel*     m_model   = nullptr;
+    QTableView*     m_table   = nullptr;
+    QLabel*         m_summary = nullptr;
+    QPushButton*    m_fix     = nullptr;
+};
+
+#endif // VALIDATIONDIALOG_H